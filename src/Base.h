@@ -31,6 +31,7 @@
 typedef uint8_t		byte;
 typedef uint16_t	word;
 typedef uint32_t	dword;
+typedef uint64_t	qword;
 
 //
 //	Define come core constant values used across the program.
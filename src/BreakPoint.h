@@ -76,6 +76,21 @@ class BreakPoint {
 			return( 0 );
 		}
 		//
+		//	Return true if any break point falls within the
+		//	addresses from 'starts' up to (but not including)
+		//	'ends'.  Unlike check() transient break points are
+		//	left in place.
+		//
+		bool inside( dword starts, dword ends ) {
+			for( breakpoint *p = _transient; p != NULL; p = p->next ) {
+				if(( p->starts < ends )&&( p->ends > starts )) return( true );
+			}
+			for( breakpoint *p = _active; p != NULL; p = p->next ) {
+				if(( p->starts < ends )&&( p->ends > starts )) return( true );
+			}
+			return( false );
+		}
+		//
 		//	Add a new transient break point on a single address.
 		//
 		int add( dword adrs ) {
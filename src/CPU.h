@@ -8,9 +8,12 @@
 #define _CPU_H_
 
 //
-//	We use Symbols.
+//	We use Symbols, BreakPoints, WatchPoints and HeatMaps.
 //
 #include "Symbols.h"
+#include "BreakPoint.h"
+#include "WatchPoint.h"
+#include "HeatMap.h"
 
 //
 //	These are our valid addressing domains
@@ -23,6 +26,34 @@ typedef enum {
 	Data_Address
 } AddressDomain;
 
+//
+//	The reasons for which CPU::run() can return.  The
+//	conditions which are checked are selected with a mask
+//	made from BIT( word, reason ) values; the budget is
+//	always honoured.
+//
+typedef enum {
+	Stop_Budget,		// Instruction or cycle budget exhausted
+	Stop_Breakpoint,	// A breakpoint has been reached
+	Stop_Exception,		// The Reporter has recorded an exception
+	Stop_Interrupted,	// The running flag has been cleared (SIGINT)
+	Stop_Sleep,		// A SLEEP instruction has been executed
+	Stop_Watchpoint		// A data watchpoint has been triggered
+} StopReason;
+
+static const word Stop_All = BIT( word, Stop_Breakpoint ) | BIT( word, Stop_Exception ) | BIT( word, Stop_Interrupted ) | BIT( word, Stop_Sleep ) | BIT( word, Stop_Watchpoint );
+
+//
+//	The units in which a CPU::run() budget is given.  An
+//	Until_Cycle budget is the clock count at which to stop
+//	rather than an amount to use.
+//
+typedef enum {
+	Instruction_Budget,
+	Cycle_Budget,
+	Until_Cycle
+} BudgetUnit;
+
 //
 //	Base Types
 //
@@ -40,6 +71,89 @@ class CPU {
 		//
 		virtual void step( void ) = 0;
 
+		//
+		//	Execute the basic block of straight line code at the
+		//	current address (no more than 'limit' instructions),
+		//	returning the number of instructions executed.
+		//
+		virtual word run_block( word limit ) = 0;
+
+		//
+		//	Return the address following the block which
+		//	run_block() would execute next.
+		//
+		virtual dword block_end( void ) = 0;
+
+		//
+		//	Supply the break points, watch points and the "keep
+		//	running" flag which run() will check.
+		//
+		virtual void stop_on( BreakPoint *breaks, WatchPoint *watches, volatile bool *running ) = 0;
+
+		//
+		//	Execute instructions until 'budget' (in 'unit's, 0
+		//	for unlimited) is exhausted or one of the conditions
+		//	in 'stop_mask' is met.  The number of instructions
+		//	executed is returned through 'executed' and the
+		//	break or watch point number (when relevant) through
+		//	'hit'.
+		//
+		virtual StopReason run( qword budget, BudgetUnit unit, word stop_mask, qword *executed, int *hit ) = 0;
+
+		//
+		//	Report the most frequently executed basic blocks.
+		//
+		virtual void profile( int count, Symbols *labels, FILE *to ) = 0;
+
+		//
+		//	Report how often fused instruction sequences ran.
+		//
+		virtual void fusions( FILE *to ) = 0;
+
+		//
+		//	Enable (or disable) the skipping of busy wait loops,
+		//	and report what has been skipped.
+		//
+		virtual void skip_loops( bool enable ) = 0;
+		virtual void busy_loops( FILE *to ) = 0;
+
+		//
+		//	Enable (or disable) the translation of hot blocks
+		//	to native code, and report its use.
+		//
+		virtual void jit( Symbols *labels, bool enable ) = 0;
+		virtual void natives( FILE *to ) = 0;
+
+		//
+		//	Enable (or disable) the reporting of reads from data
+		//	memory which has not been written since reset.
+		//
+		virtual void uninitialised( Symbols *labels, bool enable ) = 0;
+
+		//
+		//	Set the lowest address the stack may use (0 for no
+		//	limit) and the address of a variable holding the top
+		//	of the heap (0 for none); a stack reaching below
+		//	either is reported.  Report the stack used.
+		//
+		virtual void stack_limit( Symbols *labels, word limit, word brkval ) = 0;
+		virtual void stack_usage( Symbols *labels, FILE *to ) = 0;
+
+		//
+		//	Export the MCU state (registers, pins and SRAM) through
+		//	a named POSIX shared memory segment (see SharedState.h),
+		//	updated every 'every' clock cycles while running, and
+		//	publish the current state there.
+		//
+		virtual bool share_state( const char *name, dword every ) = 0;
+		virtual void publish( void ) = 0;
+
+		//
+		//	Record data space accesses in a heat map (NULL to
+		//	stop recording).
+		//
+		virtual void heat_map( HeatMap *map ) = 0;
+
 		//
 		//	Disassemble the instruction at address
 		//
@@ -70,6 +184,12 @@ class CPU {
 		//	Return true if there was something there, false otherwise.
 		//
 		virtual bool examine( AddressDomain domain, word adrs, Symbols *labels, char *buffer, int max ) = 0;
+
+		//
+		//	Time the instruction decoding mechanisms against the
+		//	program currently loaded, reporting results to 'to'.
+		//
+		virtual void benchmark( int passes, FILE *to ) = 0;
 };
 
 #endif
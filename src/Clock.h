@@ -6,6 +6,24 @@
 //	other objects to be 'ticked' as the clock
 //	notes the passing of time.
 //
+//	Rather than being ticked on every cycle, objects can
+//	instead ask to be told when the clock reaches a
+//	specific cycle (an event).  Events are kept in a
+//	heap, earliest first, so while nothing is being
+//	ticked the clock moves straight from one event to
+//	the next however many cycles lie between them.
+//
+//	Events are timed in one of a number of clock domains,
+//	each ticking at a rational fraction of the crystal (the
+//	CPU and I/O clocks, divided down by CLKPR, and the
+//	watchdog and Timer2 oscillators).  Time itself is kept
+//	in crystal cycles, and when CLKPR changes the events
+//	pending on the CPU and I/O clocks are re-timed.
+//
+//	The clock can also be paced, holding the simulation to
+//	real (wall clock) time or a multiple of it.  This is done
+//	with an event of its own, so costs nothing when unpaced.
+//
 
 #ifndef _CLOCK_H_
 #define _CLOCK_H_
@@ -13,6 +31,9 @@
 //
 //	Include the base definitions.
 //
+#include <time.h>
+#include <errno.h>
+
 #include "Base.h"
 #include "Validation.h"
 #include "DeviceRegister.h"
@@ -38,11 +59,28 @@ class Tick {
 		virtual void tick( word handle, bool inst_end ) = 0;
 };
 
+//
+//	Define the API Class through which the Clock
+//	tells an object that a cycle it scheduled an
+//	event for has arrived.
+//
+class Event {
+	public:
+		//
+		//	Called as the clock reaches the cycle at
+		//	which the event was due.
+		//
+		//	'handle' gives identifier used when the
+		//	event was registered with the clock.
+		//
+		virtual void event( word handle ) = 0;
+};
+
 
 //
 //	The Clock implementation
 //
-class Clock : public Notification {
+class Clock : public Notification, public Event {
 	public:
 		//
 		//	This is the handle of the device register access
@@ -56,6 +94,19 @@ class Clock : public Notification {
 		static const byte size_CLKPS = 4;
 		static const byte lsb_size_CLKPS = 0;
 		static const byte mask_CLKPS = MASK( byte, size_CLKPS );
+
+		//
+		//	The clock domains events can be timed in, and the
+		//	rates of the fixed oscillators (in Hz).
+		//
+		static const word Crystal_Domain = 0;
+		static const word CPU_Domain = 1;
+		static const word IO_Domain = 2;
+		static const word WDT_Domain = 3;
+		static const word TOSC_Domain = 4;
+		static const word Domains = 5;
+		static const dword WDT_Hz = 128000;
+		static const dword TOSC_Hz = 32768;
 		
 	private:
 		//
@@ -85,6 +136,57 @@ class Clock : public Notification {
 		//	This is the array of ticking targets.
 		//
 		ticking		*_list;
+
+		//
+		//	Each domain ticks once every 'per'/'div' crystal
+		//	cycles, the fraction in its lowest terms.  Ticks
+		//	fall on the crystal cycles at which
+		//
+		//		( cycle + per - origin ) * div
+		//
+		//	reaches a multiple of 'per', with 'origin' kept
+		//	below 'per'.  Only the difference between two tick
+		//	numbers has any meaning.
+		//
+		struct domain {
+			qword	per,
+				div,
+				origin;
+		};
+		domain		_domain[ Domains ];
+
+		//
+		//	Define the data we need to manage each event;
+		//	'place' is its position in the heap when it is
+		//	scheduled, and 'domain' the clock it is timed on.
+		//
+		static const word max_events = 32;
+		static const word not_scheduled = 0xFFFF;
+		static const word after_instruction = 0xFFFE;
+		struct scheduled {
+			Event	*target;
+			word	handle,
+				place,
+				domain;
+			qword	due;
+		};
+		scheduled	_event[ max_events ];
+		word		_events;
+
+		//
+		//	The heap of scheduled events, the earliest due
+		//	at the top.
+		//
+		word		_heap[ max_events ],
+				_heaped;
+
+		//
+		//	Events waiting for the end of the instruction in
+		//	progress before they can be timed ('due' then
+		//	holds the delay which follows it).
+		//
+		word		_after[ max_events ],
+				_waiting;
 		
 		//
 		//	Clock speed in KHz, and the practical
@@ -101,15 +203,212 @@ class Clock : public Notification {
 		dword		_tick_limit,
 				_us_limit;
 
+		//
+		//	Real time pacing.  While '_pace' (the number of
+		//	simulated seconds per real second) is non-zero the
+		//	pacing event checks every '_pace_every' cycles that
+		//	the simulation is not ahead of the real time, in ns,
+		//	at which it passed '_pace_count', and sleeps if it is.
+		//	Falling further behind than '_pace_slack' is reported
+		//	and forgiven.  A sleep cut short by a signal is only
+		//	carried on while '_running' (if supplied) is true.
+		//
+		static const word Pace_Check = 0;
+		static const qword pace_slack = 250000000;
+		double		_pace;
+		volatile bool	*_running;
+		word		_pace_event;
+		qword		_pace_every,
+				_pace_count,
+				_pace_start;
+
+		//
+		//	Return the real time (ns) on the monotonic clock.
+		//
+		static qword now_ns( void ) {
+			struct timespec	t;
+
+			clock_gettime( CLOCK_MONOTONIC, &t );
+			return( (qword)t.tv_sec * 1000000000 + t.tv_nsec );
+		}
+
 		//
 		//	Keep track of ticks as they go by.
 		//
-		//	This is a limited mechanism.  If this is supposed
-		//	to be simulating a 16MHz clock then this will wrap
-		//	back to 0 after just 4.47 simulated seconds (though
-		//	in real time who knows how long this might be).
+		//	At 16MHz a 64 bit count lasts for over 36,000 years
+		//	of simulated time, so it is never expected to wrap.
+		//
+		qword	_count;
+
+		//
+		//	The CPU cycles which have passed.
+		//
+		qword	_cycles;
+
+		//
+		//	Domain arithmetic.  The number of ticks of domain
+		//	'd' up to and including crystal cycle 't', the
+		//	number before it, and the cycle on which tick 'k'
+		//	falls.
 		//
-		dword	_count;
+		qword passed( word d, qword t ) {
+			domain	*p = &_domain[ d ];
+
+			return(( t + p->per - p->origin ) * p->div / p->per );
+		}
+		qword before( word d, qword t ) {
+			domain	*p = &_domain[ d ];
+
+			return((( t + p->per - p->origin ) * p->div - 1 ) / p->per );
+		}
+		qword edge( word d, qword k ) {
+			domain	*p = &_domain[ d ];
+
+			return(( k * p->per + p->div - 1 ) / p->div + p->origin - p->per );
+		}
+
+		//
+		//	Set a domain to tick every 'per'/'div' crystal
+		//	cycles, in step with the present cycle.
+		//
+		void ratio( word d, qword per, qword div ) {
+			qword	a, b;
+
+			for( a = per, b = div; b; ) {
+				qword	r = a % b;
+
+				a = b;
+				b = r;
+			}
+			_domain[ d ].per = per / a;
+			_domain[ d ].div = div / a;
+			_domain[ d ].origin = _count % _domain[ d ].per;
+		}
+
+		//
+		//	Divide the CPU and I/O clocks down from the crystal,
+		//	keeping the events pending on them the same number
+		//	of their ticks away.
+		//
+		void prescale( qword per ) {
+			word	moved[ max_events ],
+				n;
+
+			n = 0;
+			for( word e = 0; e < _events; e++ ) {
+				word	d = _event[ e ].domain;
+
+				if((( d == CPU_Domain )||( d == IO_Domain )) && ( _event[ e ].place < _heaped )) {
+					qword	left = passed( d, _event[ e ].due ) - passed( d, _count );
+
+					unschedule( e );
+					_event[ e ].due = left;
+					moved[ n++ ] = e;
+				}
+			}
+			ratio( CPU_Domain, per, 1 );
+			ratio( IO_Domain, per, 1 );
+			while( n ) {
+				word	e = moved[ --n ];
+
+				enter( e, edge( _event[ e ].domain, passed( _event[ e ].domain, _count ) + _event[ e ].due ));
+			}
+		}
+
+		//
+		//	Heap maintenance.
+		//
+		bool earlier( word a, word b ) {
+			return( _event[ _heap[ a ]].due < _event[ _heap[ b ]].due );
+		}
+		void exchange( word a, word b ) {
+			word	e;
+
+			e = _heap[ a ];
+			_heap[ a ] = _heap[ b ];
+			_heap[ b ] = e;
+			_event[ _heap[ a ]].place = a;
+			_event[ _heap[ b ]].place = b;
+		}
+		void rise( word p ) {
+			while(( p > 0 ) && earlier( p, ( p - 1 ) >> 1 )) {
+				exchange( p, ( p - 1 ) >> 1 );
+				p = ( p - 1 ) >> 1;
+			}
+		}
+		void sink( word p ) {
+			word	c;
+
+			while(( c = ( p << 1 ) + 1 ) < _heaped ) {
+				if((( c + 1 ) < _heaped ) && earlier( c + 1, c )) c++;
+				if( !earlier( c, p )) break;
+				exchange( c, p );
+				p = c;
+			}
+		}
+
+		//
+		//	Place an event in the heap, due at cycle 'due'.
+		//
+		void enter( word e, qword due ) {
+			_event[ e ].due = due;
+			_event[ e ].place = _heaped;
+			_heap[ _heaped ] = e;
+			rise( _heaped++ );
+		}
+
+		//
+		//	Take an event out of the heap, or the events
+		//	waiting for the end of an instruction.
+		//
+		void unschedule( word e ) {
+			word	p;
+
+			switch( p = _event[ e ].place ) {
+				case not_scheduled: {
+					return;
+				}
+				case after_instruction: {
+					for( word i = 0; i < _waiting; i++ ) {
+						if( _after[ i ] == e ) {
+							_after[ i ] = _after[ --_waiting ];
+							break;
+						}
+					}
+					break;
+				}
+				default: {
+					if( p < --_heaped ) {
+						word	m;
+
+						//
+						//	Move the last event in the heap
+						//	into the gap and then to where
+						//	it belongs.
+						//
+						m = _heap[ _heaped ];
+						_heap[ p ] = m;
+						_event[ m ].place = p;
+						rise( p );
+						sink( _event[ m ].place );
+					}
+					break;
+				}
+			}
+			_event[ e ].place = not_scheduled;
+		}
+
+		//
+		//	Tell the targets of all the events now due.
+		//
+		void dispatch( void ) {
+			word	e;
+
+			while(( _heaped > 0 ) && ( _event[ e = _heap[ 0 ]].due <= _count )) {
+				unschedule( e );
+				_event[ e ].target->event( _event[ e ].handle );
+			}
+		}
 
 	public:
 		//
@@ -127,24 +426,89 @@ class Clock : public Notification {
 			//	Start pre-scaler empty.
 			//
 			_clkpr = 0;
+			declare( CLKPR, &_clkpr, Write_Hook );
 			//
-			//	Start with an empty list.
+			//	Start with an empty list, and no events.
 			//	
 			_list = NULL;
+			_events = 0;
+			_heaped = 0;
+			_waiting = 0;
 			//
 			//	Our 'real world' clock counter
 			//	
 			_count = 0;
+			_cycles = 0;
 			//
 			//	Save clock speed and pertinent limits.
 			//
 			_khz = khz;
+			//
+			//	The CPU and I/O clocks start undivided.
+			//
+			ratio( Crystal_Domain, 1, 1 );
+			ratio( CPU_Domain, 1, 1 );
+			ratio( IO_Domain, 1, 1 );
+			ratio( WDT_Domain, (qword)khz * 1000, WDT_Hz );
+			ratio( TOSC_Domain, (qword)khz * 1000, TOSC_Hz );
 			_max = 0xFFFF / _khz;
 			//
 			//	Calculate the human cutoff limits.
 			//
 			_tick_limit = khz * 5;
 			_us_limit = khz * 250;
+			//
+			//	Run unpaced, checking every 10ms of simulated
+			//	time once paced.
+			//
+			_pace = 0;
+			_running = NULL;
+			_pace_event = event( Pace_Check, this );
+			_pace_every = (qword)khz * 10;
+			_pace_count = 0;
+			_pace_start = 0;
+		}
+
+		//
+		//	Set the pace of the simulation as a multiple of
+		//	real time (0 to run as fast as possible), with the
+		//	"keep running" flag which a signal clears to stop
+		//	the simulation.
+		//
+		void pace( double ratio, volatile bool *running ) {
+			_pace = ( ratio > 0 )? ratio: 0;
+			_running = running;
+			resume();
+			_report->report( Information_Level, Clock_Module, _instance, Config_Change, ( _pace > 0 )? "Paced at %gx real time": "Unpaced", _pace );
+		}
+
+		//
+		//	Restart pacing from the present, as after the
+		//	simulation has been stopped for a while.
+		//
+		void resume( void ) {
+			if( _pace > 0 ) {
+				_pace_count = _count;
+				_pace_start = now_ns();
+				schedule( _pace_event, _pace_every );
+			}
+			else {
+				cancel( _pace_event );
+			}
+		}
+
+		//
+		//	Return the number of clock cycles in each tick
+		//	of a slower clock running at 'khz'.
+		//
+		word period( word khz ) {
+			word	p;
+
+			if(( p = _khz / khz ) == 0 ) {
+				_report->report( Warning_Level, Clock_Module, _instance, Too_Fast, "Sub clock rate too fast (%d KHz)", khz );
+				p = 1;
+			}
+			return( p );
 		}
 
 		//
@@ -162,10 +526,7 @@ class Clock : public Notification {
 			p = new ticking;
 			p->target = dev;
 			p->handle = id;
-			if(( p->interval = _khz / khz ) == 0 ) {
-				_report->report( Warning_Level, Clock_Module, _instance, Too_Fast, "Sub clock rate too fast (%d KHz)", khz );
-				p->interval = 1;
-			}
+			p->interval = period( khz );
 			p->remaining = p->interval;
 			p->next = _list;
 			_list = p;
@@ -173,25 +534,152 @@ class Clock : public Notification {
 		}
 
 		//
-		//	Call with the number of ticks which
+		//	Register a new event with the clock, timed in
+		//	crystal cycles or the ticks of another domain,
+		//	returning the number by which it is scheduled.
+		//
+		word event( word id, Event *dev ) {
+			return( event( id, dev, Crystal_Domain ));
+		}
+		word event( word id, Event *dev, word domain ) {
+			ASSERT( _events < max_events );
+			ASSERT( domain < Domains );
+
+			_event[ _events ].target = dev;
+			_event[ _events ].handle = id;
+			_event[ _events ].place = not_scheduled;
+			_event[ _events ].domain = domain;
+			_event[ _events ].due = 0;
+			return( _events++ );
+		}
+
+		//
+		//	Schedule an event for 'delay' ticks of its domain
+		//	from now or, using after(), from the end of the
+		//	instruction in progress.  Any earlier schedule for
+		//	the event is replaced.
+		//
+		void schedule( word e, qword delay ) {
+			ASSERT( e < _events );
+			ASSERT( delay > 0 );
+
+			unschedule( e );
+			enter( e, edge( _event[ e ].domain, passed( _event[ e ].domain, _count ) + delay ));
+		}
+		void after( word e, qword delay ) {
+			ASSERT( e < _events );
+			ASSERT( delay > 0 );
+
+			unschedule( e );
+			_event[ e ].due = delay;
+			_event[ e ].place = after_instruction;
+			_after[ _waiting++ ] = e;
+		}
+
+		//
+		//	Cancel an event.
+		//
+		void cancel( word e ) {
+			ASSERT( e < _events );
+
+			unschedule( e );
+		}
+
+		//
+		//	Return true if an event has been timed and is
+		//	waiting to happen.
+		//
+		bool pending( word e ) {
+			ASSERT( e < _events );
+
+			return( _event[ e ].place < _heaped );
+		}
+
+		//
+		//	Return the number of ticks of its domain before
+		//	a pending event is due.
+		//
+		qword due( word e ) {
+			ASSERT( pending( e ));
+
+			return( passed( _event[ e ].domain, _event[ e ].due ) - passed( _event[ e ].domain, _count ));
+		}
+
+		//
+		//	Return true while any device is still being ticked
+		//	on every cycle.
+		//
+		bool ticked( void ) {
+			return( _list != NULL );
+		}
+
+		//
+		//	Return how many CPU cycles (at least one and no
+		//	more than 'limit') can pass before anything other
+		//	than the CPU might happen, the next event being due
+		//	by the end of the last of them.  While devices are
+		//	being ticked this is only ever one.
+		//
+		qword quiet( qword limit ) {
+			qword	gap;
+
+			if( _list != NULL ) return( 1 );
+			if(( _heaped > 0 ) && (( gap = before( CPU_Domain, _event[ _heap[ 0 ]].due ) + 1 - passed( CPU_Domain, _count )) < limit )) return(( gap > 0 )? gap: 1 );
+			return( limit );
+		}
+
+		//
+		//	Call with the number of CPU cycles which
 		//	are supposed to be simulated.
 		//
 		//	set 'has_end' to true if the call
 		//	should emit 'inst_end' as true one
 		//	the last tick.
 		//
-		void tick( word count, bool has_end ) {
+		void tick( dword count, bool has_end ) {
+			_cycles += count;
+			count = (dword)( edge( CPU_Domain, passed( CPU_Domain, _count ) + count ) - _count );
+			if( _list == NULL ) {
+				qword	ends;
+
+				//
+				//	Nothing to tick, so move straight on to each
+				//	event due in the period.
+				//
+				ends = _count + count;
+				while(( _heaped > 0 ) && ( _event[ _heap[ 0 ]].due <= ends )) {
+					_count = _event[ _heap[ 0 ]].due;
+					dispatch();
+				}
+				_count = ends;
+			}
+			else {
+				//
+				//	Loop through the number of ticks we should be
+				//	simulating. 
+				//
+				while( count-- ) {
+					_count++;
+					for( ticking *p = _list; p != NULL; p = p->next ) {
+						if(( p->remaining -= 1 ) == 0 ) {
+							p->remaining = p->interval;
+							p->target->tick( p->handle, (( count == 0 ) && has_end ));
+						}
+					}
+					if( _heaped > 0 ) dispatch();
+				}
+			}
 			//
-			//	Loop through the number of ticks we should be
-			//	simulating. 
+			//	Time any events waiting for the instruction
+			//	to end.
 			//
-			while( count-- ) {
-				_count++;
-				for( ticking *p = _list; p != NULL; p = p->next ) {
-					if(( p->remaining -= 1 ) == 0 ) {
-						p->remaining = p->interval;
-						p->target->tick( p->handle, (( count == 0 ) && has_end ));
-					}
+			if( has_end ) {
+				while( _waiting > 0 ) {
+					word	e;
+
+					e = _after[ --_waiting ];
+					_event[ e ].place = not_scheduled;
+					enter( e, edge( _event[ e ].domain, passed( _event[ e ].domain, _count ) + _event[ e ].due ));
 				}
 			}
 		}
@@ -212,41 +700,101 @@ class Clock : public Notification {
 		}
 
 		//
-		//	Return how many ticks we have handled.
+		//	Convert a duration, given in units of 1/'per_second'
+		//	of a second (1 for seconds, 1000 for ms and so on),
+		//	to clock ticks.
+		//
+		qword ticks( qword duration, qword per_second ) {
+			ASSERT( per_second > 0 );
+			return( mul_div<qword>( duration, (qword)_khz * 1000, per_second ));
+		}
+
+		//
+		//	Return how many crystal cycles have passed, or
+		//	how many CPU cycles.
 		//
-		dword count( void ) {
+		qword count( void ) {
 			return( _count );
 		}
+		qword cycles( void ) {
+			return( _cycles );
+		}
 
 		//
 		//	Return how much time has passed in ms or us.
 		//
-		dword count_ms( void ) {
+		qword count_ms( void ) {
 			return( _count / _khz );
 		}
-		dword count_us( void ) {
-			return( mul_div<dword>( _count, 1000, _khz ));
+		qword count_us( void ) {
+			return( mul_div<qword>( _count, 1000, _khz ));
 		}
 		char *count_text( char *buf, int len ) {
 			if( _count < _tick_limit ) {
-				snprintf( buf, len, "%ld", (long int)_count );
+				snprintf( buf, len, "%lld", (long long int)_count );
 			}
 			else {
 				if( _count < _us_limit ) {
-					snprintf( buf, len, "%ldus", (long int)count_us());
+					snprintf( buf, len, "%lldus", (long long int)count_us());
 				}
 				else {
-					snprintf( buf, len, "%ldms", (long int)count_ms());
+					snprintf( buf, len, "%lldms", (long long int)count_ms());
 				}
 			}
 			return( buf );
 		}
 
 		//
-		//	Reset the counter.
+		//	Reset the counter, keeping any events due the
+		//	same number of cycles ahead.
 		//
 		void reset( void ) {
+			for( word i = 0; i < _heaped; i++ ) _event[ _heap[ i ]].due -= _count;
+			for( word d = 0; d < Domains; d++ ) {
+				domain	*p = &_domain[ d ];
+
+				p->origin = ( p->origin + p->per - ( _count % p->per )) % p->per;
+			}
 			_count = 0;
+			_cycles = 0;
+			resume();
+		}
+
+		//
+		//	Clock Event API
+		//
+		virtual void event( word handle ) {
+			qword		due,
+					real;
+			struct timespec	t;
+			int		e;
+
+			ASSERT( handle == Pace_Check );
+
+			//
+			//	When should the real time have reached the
+			//	simulated time?
+			//
+			due = _pace_start + (qword)((double)( _count - _pace_count ) * 1000000.0 / ((double)_khz * _pace ));
+			if(( real = now_ns()) < due ) {
+				t.tv_sec = due / 1000000000;
+				t.tv_nsec = due % 1000000000;
+				while(( e = clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL )) != 0 ) {
+					//
+					//	Give up on any error other than a signal,
+					//	and on a signal stopping the simulation
+					//	(run() restarts the pacing).
+					//
+					if( e != EINTR ) break;
+					if( _running && !*_running ) return;
+				}
+			}
+			else if(( real - due ) > pace_slack ) {
+				_report->report( Information_Level, Clock_Module, _instance, Pacing_Lag, "Pacing %ldms behind real time", (long int)(( real - due ) / 1000000 ));
+				_pace_count = _count;
+				_pace_start = real;
+			}
+			schedule( _pace_event, _pace_every );
 		}
 
 		//
@@ -272,14 +820,19 @@ class Clock : public Notification {
 				return;
 			}
 			_clkpr = value;
-			_report->report( Information_Level, Clock_Module, _instance, Config_Change, "CLKPS new value $%02X", (int)_clkpr );
+			if( _clkpr > 8 ) {
+				_report->report( Warning_Level, Clock_Module, _instance, Parameter_Invalid, "Reserved CLKPS value $%02X", (int)_clkpr );
+				return;
+			}
+			prescale( (qword)1 << _clkpr );
+			_report->report( Information_Level, Clock_Module, _instance, Config_Change, "CLKPS new value $%02X, CPU clock %ld KHz", (int)_clkpr, (long int)( _khz >> _clkpr ));
 		}
 		//
 		//	Mechanism for examining content outside the
 		//	framework of the simulation.
 		//
 		virtual bool examine( word id, Symbols *labels, char *buffer, int max ) {
-			ASSERT( id == size_CLKPS );
+			ASSERT( id == CLKPR );
 			snprintf( buffer, max, "CLKPS=%02X", _clkpr );
 			return( true );
 		}
@@ -162,6 +162,16 @@ class Coverage {
 		//	Touch an address in a specified way..
 		//
 		void touch( dword adrs, AccessType how ) {
+			*counter( adrs, how ) += 1;
+		}
+
+		//
+		//	Return the counter for an address touched in a
+		//	specified way (creating it if necessary).  Counters
+		//	are never moved or freed, so native code can add to
+		//	them directly.
+		//
+		dword *counter( dword adrs, AccessType how ) {
 			word	b_num, b_adrs, c_adrs, p_adrs;
 
 			b_num = separate( adrs, &b_adrs, &c_adrs, &p_adrs );
@@ -210,7 +220,7 @@ class Coverage {
 			//
 			//	Finally, pp is the page we are looking for.
 			//
-			pp->address[ p_adrs ].count[ how ] += 1;
+			return( &( pp->address[ p_adrs ].count[ how ]));
 		}
 
 		//
@@ -6,6 +6,12 @@
 //	the content of a IO location (though as a memory derived
 //	class it would work anywhere).
 //
+//	A device declares how each of its registers behaves
+//	(see Notification::declare()).  A register backed by a
+//	byte of device storage and with no hooks is presented
+//	as ordinary memory, so the memory system can access
+//	it directly without calling back into the device.
+//
 
 #ifndef _DEVICE_REGISTER_H_
 #define _DEVICE_REGISTER_H_
@@ -22,6 +28,75 @@
 //
 class Notification {
 	public:
+		//
+		//	Register access kinds, combined as flags:
+		//
+		//	Plain_Register		Plain storage, read and
+		//				written directly.
+		//	Read_Only_Register	Storage read directly,
+		//				writes are ignored.
+		//	Read_Hook		Reads call read_register().
+		//	Write_Hook		Writes call write_register(),
+		//				which must update any storage
+		//				itself.
+		//
+		//	An undeclared register is treated as hooked in
+		//	both directions.
+		//
+		static const byte Plain_Register	= 0;
+		static const byte Read_Only_Register	= BIT( byte, 0 );
+		static const byte Read_Hook		= BIT( byte, 1 );
+		static const byte Write_Hook		= BIT( byte, 2 );
+		static const byte Hooked_Register	= Read_Hook | Write_Hook;
+
+	private:
+		//
+		//	The declared registers.
+		//
+		struct declared {
+			word		id;
+			byte		*storage,
+					access;
+			declared	*next;
+		};
+		declared	*_declared;
+
+	protected:
+		//
+		//	Declare a register to the memory system.  Storage
+		//	may only be NULL when the register is hooked in both
+		//	directions.
+		//
+		void declare( word id, byte *storage, byte access ) {
+			declared *ptr;
+
+			ASSERT(( storage != NULL )||(( access & Hooked_Register ) == Hooked_Register ));
+			ptr = new declared;
+			ptr->id = id;
+			ptr->storage = storage;
+			ptr->access = access;
+			ptr->next = _declared;
+			_declared = ptr;
+		}
+
+	public:
+		Notification( void ) {
+			_declared = NULL;
+		}
+		//
+		//	Return the declaration of a register, false if the
+		//	register was never declared.
+		//
+		bool declaration( word id, byte **storage, byte *access ) {
+			for( declared *ptr = _declared; ptr; ptr = ptr->next ) {
+				if( ptr->id == id ) {
+					*storage = ptr->storage;
+					*access = ptr->access;
+					return( true );
+				}
+			}
+			return( false );
+		}
 		//
 		//	These API routines provide the  interface
 		//	back from the IO register to the device
@@ -55,7 +130,13 @@ class DeviceRegister : public Memory {
 		//
 		word		_id,
 				_shift;
-				
+
+		//
+		//	How the register is accessed.
+		//
+		byte		*_storage,
+				_access;
+
 	public:
 		//
 		//	Constructor, do not allocate 64 KBytes RAM,
@@ -65,17 +146,26 @@ class DeviceRegister : public Memory {
 			_control = supervisor;
 			_id = id;
 			_shift = 0;
+			if( !supervisor->declaration( id, &_storage, &_access )) {
+				_storage = NULL;
+				_access = Notification::Hooked_Register;
+			}
 		}
 		//
 		//	Simple read or write actions
 		//
 		virtual byte read( word adrs ) {
 			ASSERT( adrs == 0 );
-			return( _control->read_register( _id ));
+			if( _access & Notification::Read_Hook ) return( _control->read_register( _id ));
+			return( *_storage );
 		}
 		virtual void write( word adrs, byte value ) {
 			ASSERT( adrs == 0 );
-			_control->write_register( _id, value );
+			if( _access & Notification::Write_Hook ) {
+				_control->write_register( _id, value );
+				return;
+			}
+			if(!( _access & Notification::Read_Only_Register )) *_storage = value;
 		}
 		//
 		//	Modify action enables a read then adjust
@@ -92,8 +182,8 @@ class DeviceRegister : public Memory {
 			byte	v;
 			
 			ASSERT( adrs == 0 );
-			v = _control->read_register( _id );
-			_control->write_register( _id, ((( v & ~clear ) | set ) ^ toggle ));
+			v = read( adrs );
+			write( adrs, ((( v & ~clear ) | set ) ^ toggle ));
 			return( v );
 		}
 		//
@@ -102,6 +192,22 @@ class DeviceRegister : public Memory {
 		virtual word capacity( void ) {
 			return( 1 );
 		}
+		//
+		//	Only a plain register is offered as storage.
+		//
+		virtual byte *storage( word adrs, word *length ) {
+			ASSERT( adrs == 0 );
+			if( _access != Notification::Plain_Register ) return( NULL );
+			*length = 1;
+			return( _storage );
+		}
+		//
+		//	Reads are steady unless they are hooked.
+		//
+		virtual bool steady( word adrs ) {
+			ASSERT( adrs == 0 );
+			return(( _storage != NULL ) && !( _access & Notification::Read_Hook ));
+		}
 
 		//
 		//	Mechanism for examining content outside the
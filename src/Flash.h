@@ -56,6 +56,29 @@
 //		https://microchipsupport.force.com/s/article/RWW-and-NRWW-in-FLASH-Memory
 //
 
+//
+//	Flash Change API
+//	================
+//
+//	Objects which keep derived copies of the flash content
+//	(such as a CPU holding predecoded instructions) register
+//	one of these with the flash to be told when their copy
+//	is no longer valid.
+//
+class FlashWatcher {
+	public:
+		//
+		//	Called after the words from 'first' up to (but
+		//	not including) 'last' have been modified.
+		//
+		virtual void flash_changed( dword first, dword last ) = 0;
+		//
+		//	Called when read access to a section of the flash
+		//	is suspended (true) and then restored (false).
+		//
+		virtual void flash_locked( bool locked ) = 0;
+};
+
 //
 //	Flash Memory API
 //
@@ -172,6 +195,12 @@ class Flash {
 		//
 		virtual bool load_hex( const char *filename ) = 0;
 
+		//
+		//	Register the object to be told about changes to
+		//	the flash content.
+		//
+		virtual void watch( FlashWatcher *target ) = 0;
+
 		//
 		//	Program space examiner API
 		//
@@ -0,0 +1,272 @@
+//
+//	HeatMap.h
+//	=========
+//
+//	A profile of data space accesses, gathered by variable
+//	(each address up to the end of the data and bss sections
+//	belonging to the nearest memory label at or below it) and
+//	by fixed windows of simulated time.  Pushes and pops are
+//	counted separately, as the stack.
+//
+
+#ifndef _HEAT_MAP_H_
+#define _HEAT_MAP_H_
+
+#include "Base.h"
+#include "Reporter.h"
+#include "Symbols.h"
+#include "Clock.h"
+
+class HeatMap {
+	private:
+		//
+		//	The data space addresses covered, and the variable
+		//	(bucket) each address belongs to.  Bucket 0 holds
+		//	addresses below the first label or beyond the end of
+		//	the bss (the heap and the stack frames), and bucket
+		//	1 the stack accesses made by pushes and pops.
+		//
+		static const dword address_range = 0x10000;
+		static const word unlabelled = 0;
+		static const word stacked = 1;
+		word		*_owner;
+		word		_buckets;
+		char		**_name;
+
+		//
+		//	Access counts are kept in pairs (reads then writes)
+		//	per bucket, for each window of '_length' clock cycles
+		//	in which there was an access.  Windows are kept in
+		//	time order.
+		//
+		struct window {
+			qword		starts;
+			dword		*count;
+			window		*next;
+		};
+		window		*_windows,
+				*_last;
+		dword		_length,
+				*_current;
+		qword		_ends;
+
+		//
+		//	Where the time comes from, and where reports go.
+		//
+		Clock		*_clock;
+		Reporter	*_report;
+		int		_instance;
+
+		//
+		//	Move on to the window containing 'now'.
+		//
+		void next_window( qword now ) {
+			window	*w;
+
+			w = new window;
+			w->starts = now - ( now % _length );
+			w->count = new dword[ _buckets * 2 ];
+			for( word i = 0; i < _buckets * 2; w->count[ i++ ] = 0 );
+			w->next = NULL;
+			if( _last ) {
+				_last->next = w;
+			}
+			else {
+				_windows = w;
+			}
+			_last = w;
+			_current = w->count;
+			_ends = w->starts + _length;
+		}
+
+		//
+		//	Discard everything gathered.
+		//
+		void discard( void ) {
+			window	*w;
+
+			while(( w = _windows )) {
+				_windows = w->next;
+				delete [] w->count;
+				delete w;
+			}
+			_last = NULL;
+			_current = NULL;
+			_ends = 0;
+			if( _name ) {
+				for( word b = 0; b < _buckets; free( _name[ b++ ]));
+				delete [] _name;
+				_name = NULL;
+			}
+			_buckets = 0;
+		}
+
+		//
+		//	The total accesses to a bucket in a window.
+		//
+		dword total( window *w, word b ) {
+			return( w->count[ b * 2 ] + w->count[ b * 2 + 1 ]);
+		}
+
+	public:
+		HeatMap( Reporter *report, int instance, Clock *clock ) {
+			_report = report;
+			_instance = instance;
+			_clock = clock;
+			_owner = new word[ address_range ];
+			_buckets = 0;
+			_name = NULL;
+			_windows = NULL;
+			_last = NULL;
+			_length = 0;
+			_ends = 0;
+			_current = NULL;
+		}
+
+		//
+		//	Start gathering afresh, with windows of 'length'
+		//	clock cycles, using the memory labels as they now
+		//	stand.
+		//
+		void start( Symbols *labels, dword length ) {
+			const char	*n;
+			dword		base,
+					last,
+					ends;
+			word		b;
+
+			ASSERT( labels != NULL );
+			ASSERT( length > 0 );
+
+			discard();
+			//
+			//	Labels only name variables up to the end of
+			//	the bss, when the linker has said where it is.
+			//
+			if( !labels->lookup( memory_address, "__bss_end", &ends ) && !labels->lookup( memory_address, "__heap_start", &ends )) ends = address_range;
+			if( ends > address_range ) ends = address_range;
+			//
+			//	First count the buckets, then name them.
+			//
+			_buckets = 2;
+			last = address_range;
+			for( dword a = 0; a < ends; a++ ) {
+				if(( labels->nearest( memory_address, a, &base ) != NULL )&&( base != last )) {
+					_buckets++;
+					last = base;
+				}
+			}
+			_name = new char *[ _buckets ];
+			_name[ unlabelled ] = strdup( "(unlabelled)" );
+			_name[ stacked ] = strdup( "(stack)" );
+			b = stacked;
+			last = address_range;
+			for( dword a = 0; a < address_range; a++ ) {
+				n = NULL;
+				if(( a < ends )&&(( n = labels->nearest( memory_address, a, &base )) != NULL )&&( base != last )) {
+					_name[ ++b ] = strdup( n );
+					last = base;
+				}
+				_owner[ a ] = ( n != NULL )? b: unlabelled;
+			}
+			_length = length;
+			_report->report( Information_Level, Coverage_Module, _instance, Config_Change, "Heat map of %d variables, %ld cycle windows", (int)_buckets, (long int)_length );
+		}
+
+		//
+		//	Note a read or write of an address.
+		//
+		inline void touch( word adrs, bool write ) {
+			qword now = _clock->count();
+
+			if(( _current == NULL )||( now >= _ends )) next_window( now );
+			_current[ _owner[ adrs ] * 2 + ( write? 1: 0 )]++;
+		}
+
+		//
+		//	Note a push (write) or pop (read) on the stack.
+		//
+		inline void stack( bool write ) {
+			qword now = _clock->count();
+
+			if(( _current == NULL )||( now >= _ends )) next_window( now );
+			_current[ stacked * 2 + ( write? 1: 0 )]++;
+		}
+
+		//
+		//	Write the matrix of accesses, one line for each
+		//	window (in which there was an access) and a column
+		//	for each variable accessed at all.  Returns false if
+		//	the file cannot be written.
+		//
+		bool matrix( const char *file ) {
+			FILE	*to;
+			bool	*used;
+
+			if(( to = fopen( file, "w" )) == NULL ) {
+				_report->report( Error_Level, Coverage_Module, _instance, File_Open_Failed, "Unable to write heat map '%s'", file );
+				return( false );
+			}
+			used = new bool[ _buckets ];
+			for( word b = 0; b < _buckets; used[ b++ ] = false );
+			for( window *w = _windows; w; w = w->next ) {
+				for( word b = 0; b < _buckets; b++ ) if( total( w, b )) used[ b ] = true;
+			}
+			fprintf( to, "# Data access heat map, %ld cycle windows\n", (long int)_length );
+			fprintf( to, "cycle" );
+			for( word b = 0; b < _buckets; b++ ) if( used[ b ]) fprintf( to, "\t%s", _name[ b ]);
+			fprintf( to, "\n" );
+			for( window *w = _windows; w; w = w->next ) {
+				fprintf( to, "%lld", (long long int)w->starts );
+				for( word b = 0; b < _buckets; b++ ) if( used[ b ]) fprintf( to, "\t%ld", (long int)total( w, b ));
+				fprintf( to, "\n" );
+			}
+			delete [] used;
+			fclose( to );
+			return( true );
+		}
+
+		//
+		//	Summarise the (up to) 'count' most accessed variables
+		//	in each window.
+		//
+		void summary( int count, FILE *to ) {
+			word	*hot;
+			int	found;
+
+			ASSERT( to != NULL );
+
+			if( count < 1 ) count = 5;
+			if( _windows == NULL ) {
+				fprintf( to, "No data accesses recorded.\n" );
+				return;
+			}
+			hot = new word[ count ];
+			for( window *w = _windows; w; w = w->next ) {
+				fprintf( to, "Cycles %lld-%lld:\n", (long long int)w->starts, (long long int)( w->starts + _length - 1 ));
+				found = 0;
+				for( word b = 0; b < _buckets; b++ ) {
+					int	i;
+
+					if( total( w, b ) == 0 ) continue;
+					for( i = found; ( i > 0 )&&( total( w, hot[ i-1 ]) < total( w, b )); i-- ) {
+						if( i < count ) hot[ i ] = hot[ i-1 ];
+					}
+					if( i < count ) {
+						hot[ i ] = b;
+						if( found < count ) found++;
+					}
+				}
+				for( int i = 0; i < found; i++ ) {
+					fprintf( to, "\t%10ld reads %10ld writes\t%s\n", (long int)w->count[ hot[ i ] * 2 ], (long int)w->count[ hot[ i ] * 2 + 1 ], _name[ hot[ i ]]);
+				}
+			}
+			delete [] hot;
+		}
+};
+
+#endif
+
+//
+//	EOF
+//
@@ -80,6 +80,18 @@ class Interrupts {
 		//
 		virtual bool find( byte *found ) = 0;
 
+		//
+		//	Return true if find() would locate an interrupt,
+		//	without changing anything.
+		//
+		virtual bool pending( void ) = 0;
+
+		//
+		//	Return true if the specific interrupt is both
+		//	raised and active.
+		//
+		virtual bool raised( byte number ) = 0;
+
 		//
 		//	Mask an interrupt (make inactive).
 		//
@@ -220,6 +232,25 @@ template< byte last_irq > class InterruptDevice : public Interrupts {
 			return( false );
 		}
 
+		//
+		//	Is there an active and raised interrupt?
+		//
+		virtual bool pending( void ) {
+			return( _raised != 0 );
+		}
+
+		//
+		//	Is a specific interrupt active and raised?
+		//
+		virtual bool raised( byte number ) {
+			if(( number > 0 )&&( number < total_irqs )) {
+				status *irq = &( _irq[ number ]);
+
+				return( irq->active && irq->pending );
+			}
+			return( false );
+		}
+
 		//
 		//	Mask an interrupt (make inactive).
 		//
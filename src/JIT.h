@@ -0,0 +1,1022 @@
+//
+//	JIT.h
+//	=====
+//
+//	Translation of hot runs of AVR code into native x86-64
+//	code.
+//
+//	Only straight line code working on the registers and
+//	SREG alone is translated (see native_op), ending at a
+//	branch or relative jump if one follows.  Anything which
+//	touches the data space, the IO registers, the stack or
+//	the CPU state stops the translation, and the native code
+//	returns to the interpreter at that instruction to carry
+//	it out through the normal Memory path.
+//
+//	Native code is placed in a single arena, one translation
+//	after another, and the whole arena is discarded when it
+//	fills.  The arena is a memfd mapped twice: code is written
+//	through a read/write view and run through a separate read/
+//	execute view, so no page is ever writable and executable.
+//	Each translation is called as:
+//
+//		qword code( word *reg, byte *sreg );
+//
+//	with 'reg' pointing to the 32 AVR registers and 'sreg'
+//	to the (fully settled) status register.  It returns the
+//	address of the next instruction in the low 32 bits and
+//	the clock cycles taken in the high 32 bits.
+//
+//	While a translation runs the status register and each
+//	AVR register it uses are held in host registers:
+//
+//		rdi	The AVR register file
+//		r8	SREG
+//		rsi, r9, rbx, rbp, r12-r15
+//			Up to eight AVR registers
+//		rax, rcx, rdx, r10, r11
+//			Scratch
+//
+//	The pointer to SREG is kept on the host stack, and the
+//	AVR registers and SREG are written back as the code
+//	returns.
+//
+//	The instruction semantics (including the flags each one
+//	sets) are those of the handlers in AVR_CPU.txt, so that
+//	native and interpreted execution give identical results.
+//	Execution counts are added straight into the Coverage
+//	counters.
+//
+//	Every translation is described in /tmp/perf-PID.map so
+//	that the host 'perf' tool can attribute time spent in
+//	native code to the AVR code it came from.
+//
+
+#ifndef _JIT_H_
+#define _JIT_H_
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "Base.h"
+#include "Validation.h"
+#include "Reporter.h"
+#include "Coverage.h"
+
+class JIT {
+	public:
+		//
+		//	The AVR instructions which can be translated.
+		//
+		typedef enum {
+			Op_None,
+			Op_NOP,		Op_LDI,		Op_MOV,		Op_MOVW,
+			Op_ADD,		Op_ADC,		Op_SUB,		Op_SUBI,
+			Op_SBC,		Op_SBCI,	Op_CP,		Op_CPC,
+			Op_CPI,		Op_AND,		Op_ANDI,	Op_OR,
+			Op_ORI,		Op_EOR,		Op_COM,		Op_INC,
+			Op_DEC,		Op_LSR,		Op_ROR,		Op_ASR,
+			Op_SWAP,	Op_ADIW,	Op_SBIW,	Op_BRBS,
+			Op_BRBC,	Op_RJMP
+		} native_op;
+
+		//
+		//	A translation.
+		//
+		typedef qword (*native_code)( word *reg, byte *sreg );
+
+	private:
+		//
+		//	Where reports go...
+		//
+		Reporter	*_report;
+		int		_instance;
+
+		//
+		//	The arena (as written and as run), its size and the
+		//	bytes used so far, with the number of times it has
+		//	been emptied.
+		//
+		byte		*_arena,
+				*_exec;
+		dword		_size,
+				_used;
+		dword		_flushes;
+
+		//
+		//	The perf map file (if it could be opened).
+		//
+		FILE		*_perf;
+
+		//
+		//	The translation under construction; '_code' is
+		//	where the next byte goes.
+		//
+		byte		*_code;
+
+		//
+		//	No translation is started unless this many bytes
+		//	are left for each instruction, plus the entry and
+		//	exit code.
+		//
+		static const dword inst_space = 192;
+		static const dword fixed_space = 256;
+
+		//
+		//	Host register numbers.
+		//
+		static const byte rAX = 0;
+		static const byte rCX = 1;
+		static const byte rDX = 2;
+		static const byte rBX = 3;
+		static const byte rBP = 5;
+		static const byte rSI = 6;
+		static const byte rDI = 7;
+		static const byte r8 = 8;
+		static const byte r9 = 9;
+		static const byte r10 = 10;
+		static const byte r11 = 11;
+		static const byte r12 = 12;
+		static const byte r13 = 13;
+		static const byte r14 = 14;
+		static const byte r15 = 15;
+
+		//
+		//	The host registers which hold AVR registers, and
+		//	how the AVR registers of a translation map onto
+		//	them (none where 'host' is zero).
+		//
+		static const byte host_regs = 8;
+		byte		_host[ 32 ];
+		bool		_dirty[ 32 ];
+		byte		_avr[ host_regs ];
+		byte		_cached;
+
+		//
+		//	Names of the SREG bits.
+		//
+		static const byte flag_C = BIT( byte, 0 );
+		static const byte flag_Z = BIT( byte, 1 );
+		static const byte flag_N = BIT( byte, 2 );
+		static const byte flag_V = BIT( byte, 3 );
+		static const byte flag_S = BIT( byte, 4 );
+		static const byte flag_H = BIT( byte, 5 );
+
+		//
+		//	x86 condition codes used.
+		//
+		static const byte cc_B = 0x2;
+		static const byte cc_Z = 0x4;
+		static const byte cc_NZ = 0x5;
+		static const byte cc_A = 0x7;
+
+		//
+		//	x86 group 1 (arithmetic) and group 2 (shift)
+		//	operations, and the register to register forms
+		//	of the group 1 operations.
+		//
+		static const byte alu_add = 0;
+		static const byte alu_or = 1;
+		static const byte alu_and = 4;
+		static const byte alu_sub = 5;
+		static const byte alu_xor = 6;
+		static const byte alu_cmp = 7;
+		static const byte shift_shl = 4;
+		static const byte shift_shr = 5;
+		static const byte op_add = 0x01;
+		static const byte op_or = 0x09;
+		static const byte op_and = 0x21;
+		static const byte op_sub = 0x29;
+		static const byte op_xor = 0x31;
+		static const byte op_mov = 0x89;
+		static const byte op_test = 0x85;
+
+		//
+		//	Instruction encoding
+		//	--------------------
+		//
+		inline void emit( byte b ) { *_code++ = b; }
+		inline void emit32( dword v ) {
+			for( int i = 0; i < 4; i++ ) emit( (byte)( v >> ( i << 3 )));
+		}
+		inline void emit64( qword v ) {
+			for( int i = 0; i < 8; i++ ) emit( (byte)( v >> ( i << 3 )));
+		}
+		//
+		//	The REX prefix, when needed (or always when 'force'
+		//	is set, for byte registers).
+		//
+		inline void rex( bool w, byte reg, byte rm, bool force ) {
+			byte	r = 0x40 | ( w? 0x08: 0 ) | (( reg & 8 )? 0x04: 0 ) | (( rm & 8 )? 0x01: 0 );
+
+			if(( r != 0x40 ) || force ) emit( r );
+		}
+		inline void modrm( byte mod, byte reg, byte rm ) { emit(( mod << 6 ) | (( reg & 7 ) << 3 ) | ( rm & 7 )); }
+
+		//
+		//	'op' dst,src (32 bit, register to register).
+		//
+		void rr( byte op, byte dst, byte src ) {
+			rex( false, src, dst, false );
+			emit( op );
+			modrm( 3, src, dst );
+		}
+		//
+		//	group 1 operation dst,imm32.
+		//
+		void ri( byte alu, byte dst, dword imm ) {
+			rex( false, 0, dst, false );
+			emit( 0x81 );
+			modrm( 3, alu, dst );
+			emit32( imm );
+		}
+		//
+		//	mov dst,imm32 (zero when 'imm' is).
+		//
+		void load_imm( byte dst, dword imm ) {
+			if( imm == 0 ) {
+				rr( op_xor, dst, dst );
+				return;
+			}
+			rex( false, 0, dst, false );
+			emit( 0xB8 + ( dst & 7 ));
+			emit32( imm );
+		}
+		//
+		//	group 2 operation dst,imm8.
+		//
+		void shift( byte op, byte dst, byte count ) {
+			if( count == 0 ) return;
+			rex( false, 0, dst, false );
+			emit( 0xC1 );
+			modrm( 3, op, dst );
+			emit( count );
+		}
+		//
+		//	test dst,imm32.
+		//
+		void test_imm( byte dst, dword imm ) {
+			rex( false, 0, dst, false );
+			emit( 0xF7 );
+			modrm( 3, 0, dst );
+			emit32( imm );
+		}
+		//
+		//	setcc dst8, then movzx dst,dst8.
+		//
+		void set_cc( byte cc, byte dst ) {
+			rex( false, 0, dst, true );
+			emit( 0x0F );
+			emit( 0x90 + cc );
+			modrm( 3, 0, dst );
+			rex( false, dst, dst, true );
+			emit( 0x0F );
+			emit( 0xB6 );
+			modrm( 3, dst, dst );
+		}
+		//
+		//	jcc rel32, returning where the displacement is
+		//	to be filled in (see land()).
+		//
+		byte *jump_cc( byte cc ) {
+			byte	*at;
+
+			emit( 0x0F );
+			emit( 0x80 + cc );
+			at = _code;
+			emit32( 0 );
+			return( at );
+		}
+		void land( byte *at ) {
+			dword	rel = (dword)( _code - ( at + 4 ));
+
+			for( int i = 0; i < 4; i++ ) at[ i ] = (byte)( rel >> ( i << 3 ));
+		}
+		//
+		//	push and pop a 64 bit register.
+		//
+		void push( byte r ) {
+			rex( false, 0, r, false );
+			emit( 0x50 + ( r & 7 ));
+		}
+		void pop( byte r ) {
+			rex( false, 0, r, false );
+			emit( 0x58 + ( r & 7 ));
+		}
+		//
+		//	Add one to the dword at a fixed address.
+		//
+		void tally( dword *at ) {
+			if( at == NULL ) return;
+			emit( 0x48 );		// mov rax,imm64
+			emit( 0xB8 );
+			emit64( (qword)at );
+			emit( 0x83 );		// add dword [rax],1
+			modrm( 0, 0, rAX );
+			emit( 1 );
+		}
+
+		//
+		//	Register file access
+		//	--------------------
+		//
+		//	movzx host,byte [rdi+2*avr] and mov word [rdi+2*avr],host
+		//
+		void load_avr( byte host, byte avr ) {
+			rex( false, host, rDI, false );
+			emit( 0x0F );
+			emit( 0xB6 );
+			modrm( 1, host, rDI );
+			emit( avr << 1 );
+		}
+		void store_avr( byte host, byte avr ) {
+			emit( 0x66 );
+			rex( false, host, rDI, false );
+			emit( 0x89 );
+			modrm( 1, host, rDI );
+			emit( avr << 1 );
+		}
+
+		//
+		//	The host register holding an AVR register, allocating
+		//	one if possible.  Returns false if there are none
+		//	left.
+		//
+		bool allocate( byte avr ) {
+			static const byte pool[ host_regs ] = { rSI, r9, rBX, rBP, r12, r13, r14, r15 };
+
+			if( _host[ avr ]) return( true );
+			if( _cached == host_regs ) return( false );
+			_avr[ _cached ] = avr;
+			_host[ avr ] = pool[ _cached++ ];
+			return( true );
+		}
+		inline byte reg( byte avr ) {
+			ASSERT( _host[ avr ] != 0 );
+
+			return( _host[ avr ]);
+		}
+		inline byte dirty( byte avr ) {
+			_dirty[ avr ] = true;
+			return( reg( avr ));
+		}
+
+		//
+		//	Opcode argument extraction (as the Instruction
+		//	class in AVR_CPU.txt).
+		//
+		static inline byte arg_d0_d31( word op ) { return(( op >> 4 ) & 0x1F ); }
+		static inline byte arg_r0_r31( word op ) { return(( op & 0x0F )|(( op >> 5 ) & 0x10 )); }
+		static inline byte arg_d16_d31( word op ) { return((( op >> 4 ) & 0x0F ) + 16 ); }
+		static inline byte arg_imm8( word op ) { return(( op & 0x0F )|(( op >> 4 ) & 0xF0 )); }
+		static inline byte arg_d1d0( word op ) { return(( op >> 3 ) & 0x1E ); }
+		static inline byte arg_r1r0( word op ) { return(( op & 0x0F ) << 1 ); }
+		static inline byte arg_d24_d30( word op ) { return((( op >> 3 ) & 0x06 ) + 24 ); }
+		static inline byte arg_imm6_w( word op ) { return(( op & 0x0F )|(( op >> 2 ) & 0x30 )); }
+		static inline dword arg_branch( word op ) { return(( op & 0x0200 )? ((( op >> 3 ) & 0x7F ) | 0xFFFFFF80 ): (( op >> 3 ) & 0x7F )); }
+		static inline dword arg_relative( word op ) { return(( op & 0x0800 )? (( op & 0x0FFF ) | 0xFFFFF000 ): ( op & 0x0FFF )); }
+
+		//
+		//	The AVR registers an instruction uses, returning
+		//	the number of them.
+		//
+		static byte uses( native_op op, word opcode, byte *r ) {
+			switch( op ) {
+				case Op_MOV:
+				case Op_ADD:
+				case Op_ADC:
+				case Op_SUB:
+				case Op_SBC:
+				case Op_CP:
+				case Op_CPC:
+				case Op_AND:
+				case Op_OR:
+				case Op_EOR: {
+					r[ 0 ] = arg_d0_d31( opcode );
+					r[ 1 ] = arg_r0_r31( opcode );
+					return( 2 );
+				}
+				case Op_MOVW: {
+					r[ 0 ] = arg_d1d0( opcode );
+					r[ 1 ] = r[ 0 ] + 1;
+					r[ 2 ] = arg_r1r0( opcode );
+					r[ 3 ] = r[ 2 ] + 1;
+					return( 4 );
+				}
+				case Op_ADIW:
+				case Op_SBIW: {
+					r[ 0 ] = arg_d24_d30( opcode );
+					r[ 1 ] = r[ 0 ] + 1;
+					return( 2 );
+				}
+				case Op_LDI:
+				case Op_SUBI:
+				case Op_SBCI:
+				case Op_CPI:
+				case Op_ANDI:
+				case Op_ORI: {
+					r[ 0 ] = arg_d16_d31( opcode );
+					return( 1 );
+				}
+				case Op_COM:
+				case Op_INC:
+				case Op_DEC:
+				case Op_LSR:
+				case Op_ROR:
+				case Op_ASR:
+				case Op_SWAP: {
+					r[ 0 ] = arg_d0_d31( opcode );
+					return( 1 );
+				}
+				default: {
+					break;
+				}
+			}
+			return( 0 );
+		}
+
+		//
+		//	Flag calculation
+		//	----------------
+		//
+		//	The new flags are gathered in edx, and then merged
+		//	into SREG (r8) replacing those in 'mask'.
+		//
+		//	Add 1 << 'bit' to edx if condition 'cc' holds.
+		//
+		void flag_cc( byte cc, byte bit ) {
+			set_cc( cc, r11 );
+			shift( shift_shl, r11, bit );
+			rr( op_or, rDX, r11 );
+		}
+		//
+		//	Add the value of bit 'from' of 'src' to edx as bit
+		//	'to'.
+		//
+		void flag_bit( byte src, byte from, byte to ) {
+			rr( op_mov, r11, src );
+			if( from > to ) {
+				shift( shift_shr, r11, from - to );
+			}
+			else {
+				shift( shift_shl, r11, to - from );
+			}
+			ri( alu_and, r11, BIT( dword, to ));
+			rr( op_or, rDX, r11 );
+		}
+		//
+		//	Z, N and then S (from N and V) for the 8 bit result
+		//	in 'res', the other flags already being in edx.
+		//
+		void flags_zns( byte res ) {
+			test_imm( res, 0xFF );
+			flag_cc( cc_Z, 1 );
+			flag_bit( res, 7, 2 );
+			rr( op_mov, r11, rDX );
+			shift( shift_shr, r11, 1 );
+			rr( op_xor, r11, rDX );
+			ri( alu_and, r11, flag_N );
+			shift( shift_shl, r11, 2 );
+			rr( op_or, rDX, r11 );
+		}
+		//
+		//	Replace the flags in 'mask' with those in edx.
+		//
+		void merge( byte mask ) {
+			ri( alu_and, r8, (byte)~mask );
+			rr( op_or, r8, rDX );
+		}
+		//
+		//	The add and subtract flags (see settle_sr()) for
+		//	a (ecx) +/- b (eax) giving the result in r10.  The
+		//	value in eax is lost.
+		//
+		void flags_arith( bool sub, bool half ) {
+			if( half ) {
+				//
+				//	H: (a&15)+(b&15) > 9, or (a&15) < (b&15)
+				//
+				rr( op_mov, r11, rCX );
+				ri( alu_and, r11, 0x0F );
+				rr( op_mov, rDX, rAX );
+				ri( alu_and, rDX, 0x0F );
+				if( sub ) {
+					rex( false, rDX, r11, false );		// cmp r11d,edx
+					emit( 0x39 );
+					modrm( 3, rDX, r11 );
+					set_cc( cc_B, r11 );
+				}
+				else {
+					rr( op_add, r11, rDX );
+					ri( alu_cmp, r11, 9 );
+					set_cc( cc_A, r11 );
+				}
+				rr( op_mov, rDX, r11 );
+				shift( shift_shl, rDX, 5 );
+			}
+			else {
+				load_imm( rDX, 0 );
+			}
+			//
+			//	C: bit 8 of a+b, or a < b
+			//
+			if( sub ) {
+				rex( false, rAX, rCX, false );		// cmp ecx,eax
+				emit( 0x39 );
+				modrm( 3, rAX, rCX );
+				flag_cc( cc_B, 0 );
+			}
+			else {
+				rr( op_mov, r11, rCX );
+				rr( op_add, r11, rAX );
+				shift( shift_shr, r11, 8 );
+				rr( op_or, rDX, r11 );
+			}
+			//
+			//	V: bit 7 of (a^r)&(b^r), inverted when subtracting
+			//
+			rr( op_mov, r11, rCX );
+			rr( op_xor, r11, r10 );
+			rr( op_xor, rAX, r10 );
+			rr( op_and, r11, rAX );
+			if( sub ) ri( alu_xor, r11, 0x80 );
+			ri( alu_and, r11, 0x80 );
+			shift( shift_shr, r11, 4 );
+			rr( op_or, rDX, r11 );
+			flags_zns( r10 );
+			merge(( half? flag_H: 0 ) | flag_S | flag_V | flag_N | flag_Z | flag_C );
+		}
+		//
+		//	The flags of the logical operations on the result
+		//	in 'res' (V cleared, C set if 'set_c').
+		//
+		void flags_logic( byte res, bool set_c ) {
+			load_imm( rDX, set_c? flag_C: 0 );
+			flags_zns( res );
+			merge( flag_S | flag_V | flag_N | flag_Z | ( set_c? flag_C: 0 ));
+		}
+		//
+		//	The flags of the shifts, given the original value
+		//	(ecx) and result (r10).  N is already in edx, and
+		//	V is N ^ C unless 'clear_v' (as ASR leaves it).
+		//
+		void flags_shift( bool clear_v ) {
+			flag_bit( rCX, 0, 0 );
+			if( !clear_v ) {
+				rr( op_mov, r11, rDX );
+				shift( shift_shr, r11, 2 );
+				rr( op_xor, r11, rDX );
+				ri( alu_and, r11, flag_C );
+				shift( shift_shl, r11, 3 );
+				rr( op_or, rDX, r11 );
+			}
+			//
+			//	Z and S; rebuilding N from the result gives
+			//	the same value.
+			//
+			test_imm( r10, 0xFF );
+			flag_cc( cc_Z, 1 );
+			rr( op_mov, r11, rDX );
+			shift( shift_shr, r11, 1 );
+			rr( op_xor, r11, rDX );
+			ri( alu_and, r11, flag_N );
+			shift( shift_shl, r11, 2 );
+			rr( op_or, rDX, r11 );
+			merge( flag_S | flag_V | flag_N | flag_Z | flag_C );
+		}
+		//
+		//	The flags of ADIW and SBIW, given the original value
+		//	(ecx) and result (r10) as 16 bit values.
+		//
+		void flags_word( void ) {
+			//
+			//	C: bit 15 set in the original but not the result
+			//
+			rr( op_mov, rDX, r10 );
+			ri( alu_xor, rDX, 0xFFFF );
+			rr( op_and, rDX, rCX );
+			shift( shift_shr, rDX, 15 );
+			ri( alu_and, rDX, flag_C );
+			test_imm( r10, 0xFFFF );
+			flag_cc( cc_Z, 1 );
+			flag_bit( r10, 15, 2 );
+			rr( op_mov, rAX, rCX );
+			rr( op_xor, rAX, r10 );
+			flag_bit( rAX, 15, 3 );
+			rr( op_mov, r11, rDX );
+			shift( shift_shr, r11, 1 );
+			rr( op_xor, r11, rDX );
+			ri( alu_and, r11, flag_N );
+			shift( shift_shl, r11, 2 );
+			rr( op_or, rDX, r11 );
+			merge( flag_S | flag_V | flag_N | flag_Z | flag_C );
+		}
+
+		//
+		//	Translate one (non branching) instruction.
+		//
+		void translate( native_op op, word opcode ) {
+			byte	d, r;
+
+			switch( op ) {
+				case Op_NOP: {
+					break;
+				}
+				case Op_LDI: {
+					load_imm( dirty( arg_d16_d31( opcode )), arg_imm8( opcode ));
+					break;
+				}
+				case Op_MOV: {
+					d = arg_d0_d31( opcode );
+					r = arg_r0_r31( opcode );
+					if( d != r ) rr( op_mov, dirty( d ), reg( r ));
+					break;
+				}
+				case Op_MOVW: {
+					d = arg_d1d0( opcode );
+					r = arg_r1r0( opcode );
+					if( d != r ) {
+						rr( op_mov, dirty( d ), reg( r ));
+						rr( op_mov, dirty( d+1 ), reg( r+1 ));
+					}
+					break;
+				}
+				case Op_ADD:
+				case Op_ADC:
+				case Op_SUB:
+				case Op_SBC:
+				case Op_CP:
+				case Op_CPC:
+				case Op_SUBI:
+				case Op_SBCI:
+				case Op_CPI:
+				case Op_INC:
+				case Op_DEC: {
+					bool	sub = !(( op == Op_ADD ) || ( op == Op_ADC ) || ( op == Op_INC )),
+						half = !(( op == Op_INC ) || ( op == Op_DEC ));
+
+					//
+					//	a into ecx and b into eax; the carry
+					//	is added to b as a byte, as in the
+					//	handlers.
+					//
+					switch( op ) {
+						case Op_SUBI:
+						case Op_SBCI:
+						case Op_CPI: {
+							d = arg_d16_d31( opcode );
+							load_imm( rAX, arg_imm8( opcode ));
+							break;
+						}
+						case Op_INC:
+						case Op_DEC: {
+							d = arg_d0_d31( opcode );
+							load_imm( rAX, 1 );
+							break;
+						}
+						default: {
+							d = arg_d0_d31( opcode );
+							rr( op_mov, rAX, reg( arg_r0_r31( opcode )));
+							break;
+						}
+					}
+					rr( op_mov, rCX, reg( d ));
+					if(( op == Op_ADC ) || ( op == Op_SBC ) || ( op == Op_CPC ) || ( op == Op_SBCI )) {
+						rr( op_mov, rDX, r8 );
+						ri( alu_and, rDX, flag_C );
+						rr( op_add, rAX, rDX );
+						ri( alu_and, rAX, 0xFF );
+					}
+					rr( op_mov, r10, rCX );
+					rr( sub? op_sub: op_add, r10, rAX );
+					ri( alu_and, r10, 0xFF );
+					if(( op != Op_CP ) && ( op != Op_CPC ) && ( op != Op_CPI )) rr( op_mov, dirty( d ), r10 );
+					flags_arith( sub, half );
+					break;
+				}
+				case Op_AND:
+				case Op_OR:
+				case Op_EOR: {
+					d = dirty( arg_d0_d31( opcode ));
+					rr(( op == Op_AND )? op_and: (( op == Op_OR )? op_or: op_xor ), d, reg( arg_r0_r31( opcode )));
+					flags_logic( d, false );
+					break;
+				}
+				case Op_ANDI:
+				case Op_ORI: {
+					d = dirty( arg_d16_d31( opcode ));
+					ri(( op == Op_ANDI )? alu_and: alu_or, d, arg_imm8( opcode ));
+					flags_logic( d, false );
+					break;
+				}
+				case Op_COM: {
+					d = dirty( arg_d0_d31( opcode ));
+					ri( alu_xor, d, 0xFF );
+					flags_logic( d, true );
+					break;
+				}
+				case Op_LSR:
+				case Op_ROR:
+				case Op_ASR: {
+					d = arg_d0_d31( opcode );
+					rr( op_mov, rCX, reg( d ));
+					rr( op_mov, r10, rCX );
+					shift( shift_shr, r10, 1 );
+					//
+					//	N is the bit placed at the top.
+					//
+					if( op == Op_LSR ) {
+						load_imm( rDX, 0 );
+					}
+					else {
+						if( op == Op_ROR ) {
+							rr( op_mov, rDX, r8 );
+							shift( shift_shl, rDX, 7 );
+						}
+						else {
+							rr( op_mov, rDX, rCX );
+						}
+						ri( alu_and, rDX, 0x80 );
+						rr( op_or, r10, rDX );
+						shift( shift_shr, rDX, 5 );
+					}
+					rr( op_mov, dirty( d ), r10 );
+					flags_shift( op == Op_ASR );
+					break;
+				}
+				case Op_SWAP: {
+					d = dirty( arg_d0_d31( opcode ));
+					rr( op_mov, rCX, d );
+					shift( shift_shl, rCX, 4 );
+					shift( shift_shr, d, 4 );
+					rr( op_or, d, rCX );
+					ri( alu_and, d, 0xFF );
+					break;
+				}
+				case Op_ADIW:
+				case Op_SBIW: {
+					d = arg_d24_d30( opcode );
+					rr( op_mov, rCX, reg( d+1 ));
+					shift( shift_shl, rCX, 8 );
+					rr( op_or, rCX, reg( d ));
+					rr( op_mov, r10, rCX );
+					ri(( op == Op_ADIW )? alu_add: alu_sub, r10, arg_imm6_w( opcode ));
+					ri( alu_and, r10, 0xFFFF );
+					rr( op_mov, dirty( d ), r10 );
+					ri( alu_and, dirty( d ), 0xFF );
+					rr( op_mov, dirty( d+1 ), r10 );
+					shift( shift_shr, dirty( d+1 ), 8 );
+					flags_word();
+					break;
+				}
+				default: {
+					ABORT();
+					break;
+				}
+			}
+		}
+
+		//
+		//	Write back the registers, return 'value' and
+		//	restore the host registers saved on entry.
+		//
+		void leave( qword value ) {
+			for( byte i = 0; i < _cached; i++ ) {
+				if( _dirty[ _avr[ i ]]) store_avr( _host[ _avr[ i ]], _avr[ i ]);
+			}
+			pop( rSI );
+			emit( 0x44 );			// mov [rsi],r8b
+			emit( 0x88 );
+			modrm( 0, r8, rSI );
+			for( byte i = _cached; i > 0; i-- ) {
+				byte	h = _host[ _avr[ i-1 ]];
+
+				if( h != rSI && h != r9 ) pop( h );
+			}
+			emit( 0x48 );			// mov rax,imm64
+			emit( 0xB8 );
+			emit64( value );
+			emit( 0xC3 );			// ret
+		}
+
+	public:
+		//
+		//	Create the arena, 'size' bytes in all.
+		//
+		JIT( Reporter *report, int instance, dword size ) {
+			_report = report;
+			_instance = instance;
+			_size = size;
+			_used = 0;
+			_flushes = 0;
+			_perf = NULL;
+			_arena = NULL;
+			_exec = NULL;
+#if defined( __x86_64__ )
+			void	*rw,
+				*rx;
+			int	fd;
+
+			//
+			//	One file, seen twice.
+			//
+			if(( fd = memfd_create( "SimAVR-JIT", MFD_CLOEXEC )) < 0 ) {
+				_report->report( Error_Level, JIT_Module, _instance, Not_Supported, "Unable to create code arena" );
+				return;
+			}
+			rw = MAP_FAILED;
+			rx = MAP_FAILED;
+			if(( ftruncate( fd, _size ) < 0 )
+				||(( rw = mmap( NULL, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 )) == MAP_FAILED )
+				||(( rx = mmap( NULL, _size, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0 )) == MAP_FAILED )) {
+				if( rw != MAP_FAILED ) munmap( rw, _size );
+				close( fd );
+				_report->report( Error_Level, JIT_Module, _instance, Not_Supported, "Unable to map %ld byte code arena", (long int)_size );
+				return;
+			}
+			close( fd );
+			_arena = (byte *)rw;
+			_exec = (byte *)rx;
+			{
+				char	name[ 64 ];
+
+				snprintf( name, 64, "/tmp/perf-%d.map", (int)getpid());
+				if(( _perf = fopen( name, "a" )) == NULL ) _report->report( Warning_Level, JIT_Module, _instance, File_Open_Failed, "Unable to open '%s'", name );
+			}
+#else
+			_report->report( Error_Level, JIT_Module, _instance, Not_Supported, "Native code needs an x86-64 host" );
+#endif
+		}
+		~JIT() {
+			if( _arena ) {
+				munmap( _arena, _size );
+				munmap( _exec, _size );
+			}
+			if( _perf ) fclose( _perf );
+		}
+
+		//
+		//	True if translations can be made.
+		//
+		bool available( void ) {
+			return( _arena != NULL );
+		}
+
+		//
+		//	Discard every translation (which must no longer be
+		//	called).
+		//
+		void flush( void ) {
+			_used = 0;
+			_flushes++;
+		}
+
+		//
+		//	Translate up to 'count' instructions of straight line
+		//	code starting at 'starts', the opcodes being those in
+		//	'opcode' with 'op' giving the instruction each is.
+		//
+		//	Translation stops at the first instruction which cannot
+		//	be translated or needs a ninth host register, and after
+		//	a branch or relative jump.  Returns the native code,
+		//	with the number of instructions translated and the
+		//	most clock cycles they can take, or NULL if there is
+		//	nothing worth translating or no room in the arena
+		//	(with 'full' set).
+		//
+		//	Coverage counts are kept in 'track' and the perf map
+		//	names the translation after 'name'.
+		//
+		native_code translate( const native_op *op, const word *opcode, word count, dword starts, dword pc_mask, Coverage *track, const char *name, word *length, word *cycles, bool *full ) {
+			byte	r[ 4 ],
+				n;
+			word	len,
+				ticks;
+			byte	*entry,
+				*taken;
+			dword	target;
+
+			*full = false;
+			if( _arena == NULL ) return( NULL );
+			//
+			//	How much can be translated?
+			//
+			for( byte i = 0; i < 32; i++ ) {
+				_host[ i ] = 0;
+				_dirty[ i ] = false;
+			}
+			_cached = 0;
+			ticks = 0;
+			for( len = 0; len < count; len++ ) {
+				bool	fits = true;
+
+				if( op[ len ] == Op_None ) break;
+				n = uses( op[ len ], opcode[ len ], r );
+				for( byte i = 0; i < n; i++ ) if( !allocate( r[ i ])) fits = false;
+				if( !fits ) break;
+				if(( op[ len ] == Op_BRBS ) || ( op[ len ] == Op_BRBC ) || ( op[ len ] == Op_RJMP )) {
+					ticks += 2;
+					len++;
+					break;
+				}
+				ticks += (( op[ len ] == Op_ADIW ) || ( op[ len ] == Op_SBIW ))? 2: 1;
+			}
+			//
+			//	A single instruction is not worth the call.
+			//
+			if( len < 2 ) return( NULL );
+			//
+			//	Registers allocated to an instruction that could
+			//	not be translated are not needed, but do no harm.
+			//
+			if(( _size - _used ) < ( fixed_space + (dword)len * inst_space )) {
+				*full = true;
+				return( NULL );
+			}
+			entry = _code = _arena + _used;
+			//
+			//	Entry: save the host registers used, load SREG
+			//	and the AVR registers.
+			//
+			for( byte i = 0; i < _cached; i++ ) {
+				byte	h = _host[ _avr[ i ]];
+
+				if( h != rSI && h != r9 ) push( h );
+			}
+			push( rSI );
+			emit( 0x44 );			// movzx r8d,byte [rsi]
+			emit( 0x0F );
+			emit( 0xB6 );
+			modrm( 0, r8, rSI );
+			for( byte i = 0; i < _cached; i++ ) load_avr( _host[ _avr[ i ]], _avr[ i ]);
+			//
+			//	The instructions, counting each execution.
+			//
+			taken = NULL;
+			target = 0;
+			for( word i = 0; i < len; i++ ) {
+				dword	adrs = ( starts + i ) & pc_mask;
+
+				tally( track->counter( adrs, Execute_Access ));
+				switch( op[ i ]) {
+					case Op_BRBS:
+					case Op_BRBC: {
+						target = ( adrs + 1 + arg_branch( opcode[ i ])) & pc_mask;
+						test_imm( r8, BIT( dword, opcode[ i ] & 7 ));
+						taken = jump_cc(( op[ i ] == Op_BRBS )? cc_NZ: cc_Z );
+						break;
+					}
+					case Op_RJMP: {
+						target = ( adrs + 1 + arg_relative( opcode[ i ])) & pc_mask;
+						break;
+					}
+					default: {
+						translate( op[ i ], opcode[ i ]);
+						break;
+					}
+				}
+			}
+			//
+			//	Exit, to the instruction following or (through
+			//	a jump) to the target of the last.
+			//
+			if( op[ len-1 ] == Op_RJMP ) {
+				tally( track->counter( target, Jump_Access ));
+				leave(( (qword)ticks << 32 ) | target );
+			}
+			else {
+				leave(( (qword)(( taken )? ticks - 1: ticks ) << 32 ) | (( starts + len ) & pc_mask ));
+				if( taken ) {
+					land( taken );
+					tally( track->counter( target, Jump_Access ));
+					leave(( (qword)ticks << 32 ) | target );
+				}
+			}
+			ASSERT( (dword)( _code - entry ) <= ( fixed_space + (dword)len * inst_space ));
+			_used = (dword)( _code - _arena );
+			//
+			//	Keep the code aligned for the host.
+			//
+			_used = ( _used + 15 ) & ~(dword)15;
+			if( _perf ) {
+				fprintf( _perf, "%lx %x AVR:%s\n", (unsigned long)( _exec + ( entry - _arena )), (unsigned int)( _code - entry ), name );
+				fflush( _perf );
+			}
+			*length = len;
+			*cycles = ticks;
+			return( (native_code)( _exec + ( entry - _arena )));
+		}
+
+		//
+		//	Report on the arena.
+		//
+		void report( FILE *to ) {
+			fprintf( to, "\tArena %ld of %ld bytes used, emptied %ld times\n", (long int)_used, (long int)_size, (long int)_flushes );
+		}
+};
+
+#endif
+
+//
+//	EOF
+//
@@ -39,6 +39,35 @@ class Map : public Memory {
 		//
 		component	*_segments;
 
+		//
+		//	The flattened map.  Once the segments are in place
+		//	every address is resolved, through any nested maps,
+		//	to the memory object finally holding it and the
+		//	address within that object, so an access is a single
+		//	indexed look up.
+		//
+		//	Adding a segment to any map (nested maps included)
+		//	bumps a count shared by all maps, and a map with a
+		//	flat table built against an older count rebuilds it
+		//	on its next access.
+		//
+		//	Where the final memory object offers plain storage
+		//	for the address (SRAM, or a device register with no
+		//	hooks) the entry points straight at it.
+		//
+		struct entry {
+			Memory		*handler;
+			word		offset;
+			byte		*direct;
+		};
+		entry		*_flat;
+		dword		_flat_at;
+		//
+		static dword &remaps( void ) {
+			static dword count = 0;
+			return( count );
+		}
+
 		//
 		//	Error handling.
 		//
@@ -73,6 +102,53 @@ class Map : public Memory {
 			return( NULL );
 		}
 
+		//
+		//	Fill in the flat table from the segments.
+		//
+		void flatten( void ) {
+			component	*ptr;
+			Memory		*h;
+			word		o,
+					l;
+
+			if( _flat == NULL ) _flat = new entry[ _size ];
+			for( word a = 0; a < _size; a++ ) {
+				if(( ptr = find( a ))) {
+					//
+					//	Addresses a nested map has no segment
+					//	for are left with that map to report.
+					//
+					if(( h = ptr->handler->locate( a - ptr->starts, &o )) == NULL ) {
+						h = ptr->handler;
+						o = a - ptr->starts;
+					}
+					_flat[ a ].handler = h;
+					_flat[ a ].offset = o;
+					//
+					//	Memory keeping a definedness shadow
+					//	has to see its own writes.
+					//
+					_flat[ a ].direct = ( h->definedness( o, &l ) == NULL )? h->storage( o, &l ): NULL;
+				}
+				else {
+					_flat[ a ].handler = NULL;
+					_flat[ a ].offset = 0;
+					_flat[ a ].direct = NULL;
+				}
+			}
+			_flat_at = remaps();
+		}
+
+		//
+		//	Return the flat table entry for an address, or
+		//	NULL if the address is not mapped.
+		//
+		entry *lookup( word adrs ) {
+			if( _flat_at != remaps()) flatten();
+			if(( adrs < _size ) && _flat[ adrs ].handler ) return( &( _flat[ adrs ]));
+			return( NULL );
+		}
+
 		//
 		//	Serialise a tree into increasing order.
 		//
@@ -160,6 +236,8 @@ class Map : public Memory {
 			_instance = instance;
 			_segments = NULL;
 			_size = size;
+			_flat = NULL;
+			_flat_at = remaps() - 1;
 		}
 
 		//
@@ -215,30 +293,51 @@ class Map : public Memory {
 			//
 			_segments = balance( _segments ); 
 			//
+			//	All flat tables need rebuilding.
+			//
+			remaps()++;
+			//
 			//	And confirm success.
 			//
 			return( true );
 		}
 
 		virtual byte read( word adrs ) {
-			component *ptr;
+			entry *ptr;
 			
-			if(( ptr = find( adrs ))) return( ptr->handler->read( adrs - ptr->starts ));
+			if(( ptr = lookup( adrs ))) {
+				if( ptr->direct ) return( *ptr->direct );
+				return( ptr->handler->read( ptr->offset ));
+			}
 			_report->report( Warning_Level, Map_Module, _instance, Address_OOR, "Read address $%04X not in mapped segment", (int)adrs );
 			return( 0 );
 		}
 		
 		virtual void write( word adrs, byte value ) {
-			component *ptr;
+			entry *ptr;
 			
-			if(( ptr = find( adrs ))) return( ptr->handler->write( adrs - ptr->starts, value ));
+			if(( ptr = lookup( adrs ))) {
+				if( ptr->direct ) {
+					*ptr->direct = value;
+					return;
+				}
+				return( ptr->handler->write( ptr->offset, value ));
+			}
 			_report->report( Warning_Level, Map_Module, _instance, Address_OOR, "Write address $%04X not in mapped segment", (int)adrs );
 		}
 		
 		virtual byte modify( word adrs, byte clear, byte set, byte toggle ) {
-			component *ptr;
+			entry *ptr;
 			
-			if(( ptr = find( adrs ))) return( ptr->handler->modify( adrs - ptr->starts, clear, set, toggle ));
+			if(( ptr = lookup( adrs ))) {
+				if( ptr->direct ) {
+					byte v = *ptr->direct;
+
+					*ptr->direct = (( v & ~clear ) | set ) ^ toggle;
+					return( v );
+				}
+				return( ptr->handler->modify( ptr->offset, clear, set, toggle ));
+			}
 			_report->report( Warning_Level, Map_Module, _instance, Address_OOR, "Modify address $%04X not in mapped segment", (int)adrs );
 			return( 0 );
 		}
@@ -246,11 +345,46 @@ class Map : public Memory {
 		virtual word capacity( void ) {
 			return( _size );
 		}
+
+		virtual byte *storage( word adrs, word *length ) {
+			component	*ptr;
+			byte		*at;
+
+			if(( ptr = find( adrs )) == NULL ) return( NULL );
+			if(( at = ptr->handler->storage( adrs - ptr->starts, length )) == NULL ) return( NULL );
+			if( *length > ( ptr->ends - adrs )) *length = ptr->ends - adrs;
+			return( at );
+		}
+
+		virtual byte *definedness( word adrs, word *length ) {
+			component	*ptr;
+			byte		*at;
+
+			if(( ptr = find( adrs )) == NULL ) return( NULL );
+			if(( at = ptr->handler->definedness( adrs - ptr->starts, length )) == NULL ) return( NULL );
+			if( *length > ( ptr->ends - adrs )) *length = ptr->ends - adrs;
+			return( at );
+		}
+
+		virtual Memory *locate( word adrs, word *offset ) {
+			entry *ptr;
+
+			if(( ptr = lookup( adrs )) == NULL ) return( NULL );
+			*offset = ptr->offset;
+			return( ptr->handler );
+		}
+
+		virtual bool steady( word adrs ) {
+			entry *ptr;
+
+			if(( ptr = lookup( adrs )) == NULL ) return( false );
+			return( ptr->handler->steady( ptr->offset ));
+		}
 		
 		virtual bool examine( word adrs, Symbols *labels, char *buffer, int max ) {
-			component *ptr;
+			entry *ptr;
 			
-			if(( ptr = find( adrs ))) return( ptr->handler->examine( adrs - ptr->starts, labels, buffer, max ));
+			if(( ptr = lookup( adrs ))) return( ptr->handler->examine( ptr->offset, labels, buffer, max ));
 			_report->report( Warning_Level, Map_Module, _instance, Address_OOR, "Examine address $%04X not in mapped segment", (int)adrs );
 			return( false );
 		}
@@ -50,6 +50,42 @@ class Memory {
 		//
 		virtual bool segment( Memory *handler, word adrs ) { return( false ); }
 
+		//
+		//	Find the memory object which finally holds an
+		//	address, and the address within that object.
+		//
+		//	Default routine holds the address itself.
+		//
+		virtual Memory *locate( word adrs, word *offset ) { *offset = adrs; return( this ); }
+
+		//
+		//	Return a pointer to the plain storage behind an
+		//	address, setting 'length' to the number of bytes
+		//	which follow it, so the content can be accessed
+		//	directly.
+		//
+		//	Default routine has no such storage.
+		//
+		virtual byte *storage( UNUSED( word adrs ), UNUSED( word *length )) { return( NULL ); }
+
+		//
+		//	Return a pointer to the definedness shadow of the
+		//	storage behind an address (one byte per storage byte,
+		//	non-zero once written), setting 'length' as above.
+		//
+		//	Default routine keeps no such shadow.
+		//
+		virtual byte *definedness( UNUSED( word adrs ), UNUSED( word *length )) { return( NULL ); }
+
+		//
+		//	Return true if reading an address has no side effect,
+		//	so the value read only changes when something writes
+		//	to it.
+		//
+		//	Default routine cannot promise this.
+		//
+		virtual bool steady( UNUSED( word adrs )) { return( false ); }
+
 		//
 		//	Mechanism for examining content outside the
 		//	framework of the simulation.
@@ -53,6 +53,13 @@ class Port : public Notification {
 			_report = report;
 			_instance = instance;
 			for( int i = 0; i < port_pins; _pin[ i++ ] = NULL );
+			//
+			//	All three registers are held in the pins
+			//	themselves.
+			//
+			declare( PINn, NULL, Hooked_Register );
+			declare( DDRn, NULL, Hooked_Register );
+			declare( PORTn, NULL, Hooked_Register );
 		}
 
 		//
@@ -71,6 +71,11 @@ template< word _page_size, word _page_count, word _boot_pages, word _op_duration
 				_pending;
 		word		_target;
 
+		//
+		//	Who needs to know when the content changes.
+		//
+		FlashWatcher	*_watcher;
+
 		//
 		//	Where we send Exceptions
 		//
@@ -111,6 +116,7 @@ template< word _page_size, word _page_count, word _boot_pages, word _op_duration
 			_locked = false;
 			_application = true;
 			_pending = None_Pending;
+			_watcher = NULL;
 		}
 
 		//
@@ -317,6 +323,9 @@ template< word _page_size, word _page_count, word _boot_pages, word _op_duration
 							//
 							//	00	Data
 							//
+							dword	first;
+
+							first = ( ext_adrs + adrs ) >> 1;
 							for( word c = 0; c < count; c++ ) {
 								word	*target;
 								dword	wide_adrs;
@@ -368,6 +377,11 @@ template< word _page_size, word _page_count, word _boot_pages, word _op_duration
 									return( false );
 								}
 							}
+							//
+							//	Tell anyone watching which words have
+							//	just been changed.
+							//
+							if( _watcher && count ) _watcher->flash_changed( first, (( ext_adrs + adrs - 1 ) >> 1 ) + 1 );
 							break;
 						}
 						case 0x01: {
@@ -517,6 +531,7 @@ template< word _page_size, word _page_count, word _boot_pages, word _op_duration
 			}
 			_pending = Erase_Pending;
 			_target = page;
+			if( _watcher && !_locked ) _watcher->flash_locked( true );
 			_locked = true;
 			_application = ( page < ( _page_count - _boot_pages ));
 			return( _op_duration );
@@ -535,6 +550,7 @@ template< word _page_size, word _page_count, word _boot_pages, word _op_duration
 			}
 			_pending = Write_Pending;
 			_target = page;
+			if( _watcher && !_locked ) _watcher->flash_locked( true );
 			_locked = true;
 			_application = ( page < ( _page_count - _boot_pages ));
 			return( _op_duration );
@@ -561,7 +577,7 @@ template< word _page_size, word _page_count, word _boot_pages, word _op_duration
 					//	This operation explicitly sets all
 					//	bits in the page to 1.
 					//
-					for( word w = 0; w < _page_size; _storage[ a++ ] = ~((word)0 ));
+					for( word w = 0; w < _page_size; w++ ) _storage[ a++ ] = ~((word)0 );
 					clear();
 					break;
 				}
@@ -571,15 +587,19 @@ template< word _page_size, word _page_count, word _boot_pages, word _op_duration
 					//
 					//	This operation ANDs the buffer with the storage.
 					//
-					for( word w = 0; w < _page_size; _storage[ a++ ] &= _buffer[ w ]);
+					for( word w = 0; w < _page_size; w++ ) _storage[ a++ ] &= _buffer[ w ];
 					break;
 				}
 				default: {
 					ABORT();
 					break;
 				}
-				_pending = None_Pending;
 			}
+			_pending = None_Pending;
+			//
+			//	Only the target page has changed.
+			//
+			if( _watcher ) _watcher->flash_changed( (dword)_target * (dword)_page_size, (dword)( _target + 1 ) * (dword)_page_size );
 		}
 		
 		//
@@ -593,6 +613,7 @@ template< word _page_size, word _page_count, word _boot_pages, word _op_duration
 		//
 		virtual void enable( void ) {
 			ASSERT( _pending == None_Pending );
+			if( _watcher && _locked ) _watcher->flash_locked( false );
 			_locked = false;
 		}
 
@@ -636,6 +657,13 @@ template< word _page_size, word _page_count, word _boot_pages, word _op_duration
 			return( adrs % _page_size );
 		}
 
+		//
+		//	Register the object watching for content changes.
+		//
+		virtual void watch( FlashWatcher *target ) {
+			_watcher = target;
+		}
+
 		//
 		//	Program space examiner API
 		//
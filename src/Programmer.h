@@ -86,7 +86,7 @@
 //
 //	The Self Programming Class
 //
-class Programmer : public Tick, Notification {
+class Programmer : public Event, public Notification {
 	public:
 		//
 		//	This is the handle that the Device Register will use
@@ -95,9 +95,13 @@ class Programmer : public Tick, Notification {
 		static const word SPMCSR = 0;
 
 		//
-		//	Handle for the system clock.
+		//	Handles for the clock events: the end of the window
+		//	following a write to SPMCSR in which an SPM or LPM
+		//	instruction acts on it, and the completion of a
+		//	flash page write or erase.
 		//
-		static const word System_Clock = 0;
+		static const word SPM_Window = 0;
+		static const word Flash_Ready = 1;
 		
 	public:
 		//
@@ -119,17 +123,12 @@ class Programmer : public Tick, Notification {
 		virtual word call_lpm( dword from, bool increment ) = 0;
 			
 		//
-		//	Clock Tick API
-		//	==============
+		//	Clock Event API
+		//	===============
 		//
-		//	Called once for every tick which the
-		//	clock is simulating.
+		//	Called as each of the events above falls due.
 		//
-		//	This gets called frequently and is used to
-		//	simulate activities happening in parallel
-		//	while other tasks are executing.
-		//
-		virtual void tick( word id, bool inst_end ) = 0;
+		virtual void event( word id ) = 0;
 
 		//
 		//	Notification API
@@ -223,10 +222,11 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 				_pm_mode;
 
 		//
-		//	Define the SPM clock window counter.
+		//	The clock events timing the SPM window and the
+		//	flash write or erase under way.
 		//
-		word		_action_counter,	_action_counter_pending,
-				_parallel_counter;
+		word		_window_event,
+				_ready_event;
 				
 		//
 		//	Routine to update the content of
@@ -234,6 +234,8 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 		//	flags.
 		//
 		void update_spmcsr( byte value ) {
+			word	window;
+
 			_spmcsr		= ( _spmcsr & bit_RWWSB ) | ( value & ~bit_RWWSB );
 			_int_enable	= (( value & bit_SPMIE ) != 0 );
 			switch( value & control_mask ) {
@@ -242,7 +244,7 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 					//	SIGRD: Read signature byte
 					//
 					_pm_mode = PM_SIGRD;
-					_action_counter_pending = 3;
+					window = 3;
 					break;
 				}
 				case bit_RWWSRE | bit_SPMEN: {
@@ -250,7 +252,7 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 					//	RWWSRE: Read-While-Write Section Read Enable.
 					//
 					_pm_mode = PM_RWWSRE;
-					_action_counter_pending = 4;
+					window = 4;
 					break;
 				}
 				case bit_BLBSET | bit_SPMEN: {
@@ -258,7 +260,7 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 					//	BLBSET: Boot Lock Bit Set
 					//
 					_pm_mode = PM_BLBSET;
-					_action_counter_pending = 4;
+					window = 4;
 					break;
 				}
 				case bit_PGWRT | bit_SPMEN: {
@@ -266,7 +268,7 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 					//	PGWRT: Page Write
 					//
 					_pm_mode = PM_PGWRT;
-					_action_counter_pending = 4;
+					window = 4;
 					break;
 				}
 				case bit_PGERS | bit_SPMEN: {
@@ -274,7 +276,7 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 					//	PGERS: Page Erase
 					//
 					_pm_mode = PM_PGERS;
-					_action_counter_pending = 4;
+					window = 4;
 					break;
 				}
 				case bit_SPMEN: {
@@ -282,7 +284,7 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 					//	SPMEN: Write to flash buffer page
 					//
 					_pm_mode = PM_SPMEN;
-					_action_counter_pending = 4;
+					window = 4;
 					break;
 				}
 				default: {
@@ -292,12 +294,29 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 					//
 					_report->report( Error_Level, Programmer_Module, _instance, Parameter_Invalid, "Invalid SPMCSR value $%02X", (int)value );
 					_pm_mode = PM_EMPTY;
-					_action_counter_pending = 0;
+					window = 0;
 					break;
 				}
 			}
+			//
+			//	The window opens once the instruction writing
+			//	the register has completed.
+			//
+			if( window ) _clock->after( _window_event, window );
 		}
 		
+		//
+		//	Time the flash write or erase just started.
+		//
+		void flash_busy( word clocks ) {
+			if( clocks ) {
+				_clock->schedule( _ready_event, clocks );
+			}
+			else {
+				_clock->cancel( _ready_event );
+			}
+		}
+
 		//
 		//	Return the page number appropriate for the command.
 		//
@@ -324,6 +343,7 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 			//	Empty the control register
 			//
 			_spmcsr = 0;
+			declare( SPMCSR, &_spmcsr, Write_Hook );
 			_int_enable = false;
 			_pm_mode = PM_EMPTY;
 			//
@@ -337,11 +357,10 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 			_clock = clock;
 			_config = fuses;
 			//
-			//	Clear count down timers.
+			//	Our clock events.
 			//
-			_action_counter = 0;
-			_action_counter_pending = 0;
-			_parallel_counter = 0;
+			_window_event = clock->event( SPM_Window, this, Clock::CPU_Domain );
+			_ready_event = clock->event( Flash_Ready, this );
 			//
 			//	Import our Lock and Fuse based configuration.
 			//
@@ -363,11 +382,11 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 			//	Has this happened in the clock window
 			//	during which the command is valid?
 			//
-			if( _action_counter == 0 ) return( 0 );
+			if( !_clock->pending( _window_event )) return( 0 );
 			//
 			//	Clear to ensure only activated once.
 			//
-			_action_counter = 0;
+			_clock->cancel( _window_event );
 			//
 			//	The SPM instruction choices:
 			//
@@ -380,7 +399,7 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 					//	(Read While Write) feature of the flash
 					//	memory that supports it.
 					//
-					_parallel_counter = 0;
+					_clock->cancel( _ready_event );
 					_spmcsr &= ~( bit_RWWSB | bit_RWWSRE | bit_SPMEN );
 					_flash->enable();
 					return( 0 );
@@ -403,7 +422,7 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 					//
 					_spmcsr |= bit_RWWSB;
 					_spmcsr &= ~bit_PGWRT;
-					_parallel_counter = _clock->micros( _flash->write( target_page( increment )));
+					flash_busy( _clock->micros( _flash->write( target_page( increment ))));
 					break;
 				}
 				case PM_PGERS: {
@@ -412,7 +431,7 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 					//	from the high part of the Z-pointer.
 					//
 					_spmcsr |= bit_RWWSB;
-					_parallel_counter = _clock->micros( _flash->erase( target_page( increment )));
+					flash_busy( _clock->micros( _flash->erase( target_page( increment ))));
 					break;
 				}
 				case PM_SPMEN: {
@@ -423,7 +442,7 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 					//	the Z-pointer is ignored.
 					//
 					_spmcsr &= ~bit_RWWSB;
-					_parallel_counter = 0;
+					_clock->cancel( _ready_event );
 					_flash->enable();
 					_flash->place( target_word( increment ), _mcu->get_word_reg( 0 ));
 					break;
@@ -450,11 +469,11 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 			//	This is the test to see if this code
 			//	is going to hijack the LPM instruction.
 			//
-			if( _action_counter == 0 ) return( 0 );
+			if( !_clock->pending( _window_event )) return( 0 );
 			//
 			//	Clear to ensure only activated once.
 			//
-			_action_counter = 0;
+			_clock->cancel( _window_event );
 			//
 			//	The LPM instruction choices:
 			//
@@ -472,44 +491,34 @@ template< byte irq_number > class ProgrammerDevice : public Programmer {
 		}
 			
 		//
-		//	Clock Tick API
-		//	==============
+		//	Clock Event API
+		//	===============
 		//
-		//	Called once for every tick which the
-		//	clock is simulating.
+		//	Called as each of the events this device has
+		//	scheduled falls due.
 		//
-		//	This gets called frequently and is used to
-		//	simulate activities happening in parallel
-		//	while other tasks are executing.
-		//
-		virtual void tick( word id, bool inst_end ) {
-			ASSERT( id == 0 );
-			//
-			//	Count down controlling the semantics of the
-			//	LPM and SPM instructions
-			//
-			if( _action_counter_pending ) {
-				if( inst_end ) {
-					_action_counter = _action_counter_pending;
-					_action_counter_pending = 0;
-				}
-			}
-			else {
-				if( _action_counter ) {
-					if(( _action_counter -= 1 ) == 0 ) {
-						_spmcsr &= ~control_mask;
-					}
+		virtual void event( word id ) {
+			switch( id ) {
+				case SPM_Window: {
+					//
+					//	The window for the LPM and SPM
+					//	instructions has closed.
+					//
+					_spmcsr &= ~control_mask;
+					break;
 				}
-			}
-			//
-			//	Counter timing the point at which flash is
-			//	written.
-			//	
-			if( _parallel_counter ) {
-				if(( _parallel_counter -= 1 ) == 0 ) {
+				case Flash_Ready: {
+					//
+					//	The flash has been written.
+					//
 					_flash->commit();
 					_spmcsr &= ~bit_SPMEN;
 					if( _int_enable ) _irq->raise( irq_number );
+					break;
+				}
+				default: {
+					ABORT();
+					break;
 				}
 			}
 		}
@@ -35,7 +35,9 @@ static ModuleName modules[] = {
 	{ Coverage_Module,	"Coverage"		},
 	{ Application_Module,	"Application"		},
 	{ Factory_Module,	"Factory"		},
-	{ Serial_Module,	"Serial"		}
+	{ Serial_Module,	"Serial"		},
+	{ Share_Module,		"Share"			},
+	{ JIT_Module,		"JIT"			}
 };
 
 char *Reporter::module_name( Modules module, char *buffer, int len ) {
@@ -113,6 +115,7 @@ static ExceptionName exceptions[] = {
 	{ Invalid_Number,		"Number invalid"	},
 	{ Overlap_Error,		"Objects Overlap"	},
 	{ Too_Fast,			"Sub clock too quick"	},
+	{ Pacing_Lag,			"Pacing lags"		},
 	
 	{ Config_Change,		"Config Change"		},
 		
@@ -138,9 +141,11 @@ static ExceptionName exceptions[] = {
 	{ Hardware_Break,		"CPU BREAK"		},
 	{ Hardware_Sleep,		"CPU SLEEP"		},
 	{ Watchdog_Reset,		"CPU WDT Reset"		},
-	{ Watchdog_tick,		"CPU WDT tick"		},
+	{ Watchdog_Expired,		"CPU WDT expired"	},
 	{ Skip_Instruction,		"CPU Skip inst"		},
 	{ Accept_Interrupt,		"CPU Accept IRQ"	},
+	{ Uninitialised_Read,		"CPU Uninit read"	},
+	{ Stack_Collision,		"CPU Stack collision"	},
 	
 	{ Unexplained_Error,		"Unexplained error"	}
 };
@@ -40,7 +40,9 @@ typedef enum {
 	Coverage_Module,
 	Application_Module,
 	Factory_Module,
-	Serial_Module
+	Serial_Module,
+	Share_Module,
+	JIT_Module
 } Modules;
 
 //
@@ -87,6 +89,7 @@ typedef enum {
 	Invalid_Number,			// Format of number invalid.
 	Overlap_Error,			// Two items overlap in error.
 	Too_Fast,			// Sub clock too quick to simulate.
+	Pacing_Lag,			// Host too slow to hold the real time pace.
 
 	//
 	//	Information messages
@@ -121,9 +124,11 @@ typedef enum {
 	Hardware_Break,			// AVR executes debugging break point
 	Hardware_Sleep,			// AVR MCU enters sleep mode
 	Watchdog_Reset,			// AVR MCU watchdog timer has been reset
-	Watchdog_tick,			// AVR MCU watchdog clock tick...
+	Watchdog_Expired,		// AVR MCU watchdog timer has run out
 	Skip_Instruction,		// AVR MCU Skipping this instruction
 	Accept_Interrupt,		// AVR MCU Accepts Interrupt
+	Uninitialised_Read,		// AVR MCU reads memory never written
+	Stack_Collision,		// AVR MCU stack has run into the heap
 
 	//
 	//	Catch all exception
@@ -30,6 +30,12 @@ template< word size > class SRAM : public Memory {
 		//
 		byte		_ram[ size ],
 				_x;
+
+		//
+		//	The definedness shadow, a byte for each byte of
+		//	RAM which is set once that byte has been written.
+		//
+		byte		_defined[ size ];
 		
 	public:
 		//
@@ -40,6 +46,7 @@ template< word size > class SRAM : public Memory {
 			_report = handler;
 			_instance = instance;
 			for( word i = 0; i < size; _ram[ i++ ]);
+			for( word i = 0; i < size; _defined[ i++ ] = 0 );
 		}
 		//
 		//	Simple read or write actions
@@ -57,6 +64,7 @@ template< word size > class SRAM : public Memory {
 				return;
 			}
 			_ram[ adrs ] = value;
+			_defined[ adrs ] = ~0;
 		}
 		//
 		//	Modify action enables a read then adjust
@@ -78,6 +86,7 @@ template< word size > class SRAM : public Memory {
 			}
 			v = _ram[ adrs ];
 			_ram[ adrs ] = (( v & ~clear ) | set ) ^ toggle;
+			_defined[ adrs ] = ~0;
 			return( v );
 		}
 		//
@@ -87,6 +96,24 @@ template< word size > class SRAM : public Memory {
 			return( size );
 		}
 
+		//
+		//	The RAM, and its definedness shadow, can be
+		//	accessed directly.
+		//
+		virtual byte *storage( word adrs, word *length ) {
+			if( adrs >= size ) return( NULL );
+			*length = size - adrs;
+			return( &( _ram[ adrs ]));
+		}
+		virtual byte *definedness( word adrs, word *length ) {
+			if( adrs >= size ) return( NULL );
+			*length = size - adrs;
+			return( &( _defined[ adrs ]));
+		}
+		virtual bool steady( word adrs ) {
+			return( adrs < size );
+		}
+
 		//
 		//	Mechanism for examining content outside the
 		//	framework of the simulation.
@@ -91,6 +91,14 @@
 //		15-12	Reserved
 //		11-0	UBRR	0-4095
 //
+//	Each bit takes 16 (or with U2X, 8) times UBRR+1 system
+//	clock cycles, and a frame is a start bit, the data bits,
+//	the parity bit (if enabled) and the stop bits.  Rather
+//	than counting cycles, the device schedules a clock event
+//	for the end of each frame sent, and (while the receiver
+//	is enabled and its buffer empty) one for the frame of
+//	each byte waiting at the terminal, which tells the
+//	device as input is supplied.
 //
 
 //
@@ -98,7 +106,7 @@
 //
 //	generic UART declarations go in here.
 //
-class SerialDevice : public Notification, Tick {
+class SerialDevice : public Notification, public Event {
 	public:
 		//
 		//	Register handles
@@ -154,9 +162,12 @@ class SerialDevice : public Notification, Tick {
 		static const word ubrr_mask		= MASK( word, 12 );
 
 		//
-		//	Clock handle
+		//	Event handles, the frames timed by the clock
+		//	and input supplied to the terminal.
 		//
-		static const word System_Clock = 0;
+		static const word Transmit_Frame = 0;
+		static const word Receive_Frame = 1;
+		static const word Input_Supplied = 2;
 
 		//
 		//	The Device Registers API
@@ -166,9 +177,9 @@ class SerialDevice : public Notification, Tick {
 		virtual bool examine( word id, Symbols *labels, char *buffer, int max ) = 0;
 
 		//
-		//	The Clock ticking API
+		//	The Clock event API
 		//
-		virtual void tick( word handle, bool inst_end ) = 0;
+		virtual void event( word handle ) = 0;
 
 };
 
@@ -182,6 +193,7 @@ template< byte rx, byte dre, byte tx > class SerialDriver : public SerialDevice
 		Reporter	*_report;
 		int		_instance;
 		SerialIO	*_target;
+		Clock		*_clock;
 
 		//
 		//	Internal state variables
@@ -200,23 +212,27 @@ template< byte rx, byte dre, byte tx > class SerialDriver : public SerialDevice
 				_stop_bits;
 
 		//
-		//	INPUT variables
+		//	INPUT variables, the clock event for the
+		//	frame of the byte arriving.
 		//
-		dword		_input_clock_count;
+		word		_input_event;
 
 		//
-		//	OUTPUT variables
+		//	OUTPUT variables, the byte being shifted out
+		//	(if any) and the clock event for the end of
+		//	its frame.
 		//
-		dword		_output_clock_count;
+		byte		_shift;
+		bool		_sending;
+		word		_output_event;
 
 		//
 		//	This is the completely factored clock
-		//	counting target.  This is not restricted
-		//	to the UART 12 bit counter range and includes
-		//	any clock doubling required.
+		//	counting target: the system clock cycles
+		//	taken by one whole frame.
 		//
 		//	As a result a 16 word cannot hold the maximum
-		//	possible range required (4095 * 2 * 10).
+		//	possible range required (4096 * 16 * 13).
 		//
 		dword		_clock_target;
 
@@ -224,20 +240,48 @@ template< byte rx, byte dre, byte tx > class SerialDriver : public SerialDevice
 		//	simplified routines to various parameters
 		//
 		void reset_clock_target( void ) {
+			byte	bits;
+
 			//
 			//	Set the real ticks per bit sent/received.
 			//
 			if( _ucsra & ucsra_U2X ) {
-				_clock_target = _ubrr;
+				_clock_target = ( (dword)_ubrr + 1 ) << 3;
 			}
 			else {
-				_clock_target = _ubrr << 1;
+				_clock_target = ( (dword)_ubrr + 1 ) << 4;
 			}
 			//
 			//	Now multiply by the actual number of bits
-			//	to get clock counts per character of data.
+			//	(start, data, parity and stop) to get clock
+			//	counts per character of data.
 			//
-			_clock_target *= _char_bits + _stop_bits;
+			bits = 1 + _char_bits + _stop_bits;
+			if( extract<byte>( _ucsrc, SerialDevice::ucsrc_UPM_lsb, SerialDevice::ucsrc_UPM_mask )) bits++;
+			_clock_target *= bits;
+		}
+
+		//
+		//	Move the byte in the transmit buffer into the
+		//	shift register and time its frame; the buffer is
+		//	then empty again.
+		//
+		void send_frame( void ) {
+			_shift = _trans_buffer;
+			_sending = true;
+			_ucsra |= SerialDevice::ucsra_UDRE;
+			if( _ucsrb & SerialDevice::ucsrb_UDRIE ) _interrupt->raise( dre );
+			_clock->schedule( _output_event, _clock_target );
+		}
+		//
+		//	Time the frame of the next byte to arrive, if the
+		//	receiver is enabled and its buffer empty, a byte is
+		//	waiting at the terminal and no frame is timed yet.
+		//
+		void receive_next( void ) {
+			if(( _ucsrb & SerialDevice::ucsrb_RXEN ) && !( _ucsra & SerialDevice::ucsra_RXC ) && !_clock->pending( _input_event ) && _target->waiting()) {
+				_clock->schedule( _input_event, _clock_target );
+			}
 		}
 		void reset_stop_bits( void ) {
 			byte	s;
@@ -272,11 +316,12 @@ template< byte rx, byte dre, byte tx > class SerialDriver : public SerialDevice
 		}
 		
 	public:
-		SerialDriver( Reporter *report, int instance, Interrupts *interrupt, SerialIO *target ) {
+		SerialDriver( Reporter *report, int instance, Interrupts *interrupt, SerialIO *target, Clock *clock ) {
 			_report = report;
 			_instance = instance;
 			_interrupt = interrupt;
 			_target = target;
+			_clock = clock;
 
 			_recv_buffer = 0;
 			_trans_buffer = 0;
@@ -288,16 +333,33 @@ template< byte rx, byte dre, byte tx > class SerialDriver : public SerialDevice
 			_char_bits = 5;
 			_stop_bits = 1;
 
-			_input_clock_count = 0;
-			_output_clock_count = 0;
+			_input_event = clock->event( SerialDevice::Receive_Frame, this, Clock::IO_Domain );
+			_shift = 0;
+			_sending = false;
+			_output_event = clock->event( SerialDevice::Transmit_Frame, this, Clock::IO_Domain );
 			
 			_clock_target = 0;
 			_stop_bits = 0;
 			_char_bits = 0;
 
-			reset_clock_target();
 			reset_stop_bits();
 			reset_char_bits();
+			reset_clock_target();
+
+			_target->attach( this, SerialDevice::Input_Supplied );
+
+			//
+			//	UDR is two registers behind one address and
+			//	UBRR is assembled from two bytes, so these are
+			//	hooked both ways.  The control registers are
+			//	read directly.
+			//
+			declare( SerialDevice::UDRn, NULL, Hooked_Register );
+			declare( SerialDevice::UCSRnA, &_ucsra, Write_Hook );
+			declare( SerialDevice::UCSRnB, &_ucsrb, Write_Hook );
+			declare( SerialDevice::UCSRnC, &_ucsrc, Write_Hook );
+			declare( SerialDevice::UBRRnL, NULL, Hooked_Register );
+			declare( SerialDevice::UBRRnH, NULL, Hooked_Register );
 		}
 		//
 		//	The Device Registers API
@@ -305,17 +367,15 @@ template< byte rx, byte dre, byte tx > class SerialDriver : public SerialDevice
 		virtual byte read_register( word id ) {
 			switch( id ) {
 				case SerialDevice::UDRn: {
+					//
+					//	Reading the receive buffer empties it,
+					//	ready for the next byte waiting.
+					//
+					_ucsra &= ~SerialDevice::ucsra_RXC;
+					_interrupt->clear( rx );
+					receive_next();
 					return( _recv_buffer );
 				}
-				case SerialDevice::UCSRnA: {
-					return( _ucsra );
-				}
-				case SerialDevice::UCSRnB: {
-					return( _ucsrb );
-				}
-				case SerialDevice::UCSRnC: {
-					return( _ucsrc );
-				}
 				case SerialDevice::UBRRnL: {
 					return( low_byte( _ubrr ));
 				}
@@ -335,6 +395,8 @@ template< byte rx, byte dre, byte tx > class SerialDriver : public SerialDevice
 					if( _ucsra & SerialDevice::ucsra_UDRE ) {
 						_trans_buffer = value;
 						_ucsra &= ~SerialDevice::ucsra_UDRE;
+						_interrupt->clear( dre );
+						if(( _ucsrb & SerialDevice::ucsrb_TXEN ) && !_sending ) send_frame();
 					}
 					else {
 						_report->report( Warning_Level, Serial_Module, _instance, Write_Invalid, "UDR%d(TXB) busy (data %d dropped)", _instance, (int)value );
@@ -353,6 +415,7 @@ template< byte rx, byte dre, byte tx > class SerialDriver : public SerialDevice
 					if(( value & SerialDevice::ucsra_U2X ) != ( _ucsra & SerialDevice::ucsra_U2X )) {
 						_ucsra = ( _ucsra & ~SerialDevice::ucsra_U2X )|( value & SerialDevice::ucsra_U2X );
 						_report->report( Information_Level, Serial_Module, _instance, Config_Change, "U2X%d = %s", _instance, (( _ucsra & SerialDevice::ucsra_U2X )?"On" : "Off" ));
+						reset_clock_target();
 					}
 					if(( value & SerialDevice::ucsra_MPCM ) != ( _ucsra & SerialDevice::ucsra_MPCM )) {
 						_ucsra = ( _ucsra & ~SerialDevice::ucsra_MPCM )|( value & SerialDevice::ucsra_MPCM );
@@ -361,12 +424,52 @@ template< byte rx, byte dre, byte tx > class SerialDriver : public SerialDevice
 					break;
 				}
 				case SerialDevice::UCSRnB: {
+					byte	was;
+
+					//
+					//	RXB8 is read only.
+					//
+					was = _ucsrb;
+					_ucsrb = ( value & ~SerialDevice::ucsrb_RXB8 )|( _ucsrb & SerialDevice::ucsrb_RXB8 );
 					reset_char_bits();
+					reset_clock_target();
+					//
+					//	Data already waiting arrives a frame
+					//	time after the receiver is enabled.
+					//
+					if(( _ucsrb ^ was ) & SerialDevice::ucsrb_RXEN ) {
+						if( _ucsrb & SerialDevice::ucsrb_RXEN ) {
+							receive_next();
+						}
+						else {
+							_clock->cancel( _input_event );
+						}
+					}
+					//
+					//	The transmitter sends anything already
+					//	waiting once it is enabled.
+					//
+					if(( _ucsrb & SerialDevice::ucsrb_TXEN ) && !_sending && !( _ucsra & SerialDevice::ucsra_UDRE )) send_frame();
+					//
+					//	Interrupts enabled while their flag is
+					//	already set are raised at once.
+					//
+					if(( _ucsrb & SerialDevice::ucsrb_UDRIE ) && ( _ucsra & SerialDevice::ucsra_UDRE )) _interrupt->raise( dre );
+					if(( _ucsrb & SerialDevice::ucsrb_RXCIE ) && ( _ucsra & SerialDevice::ucsra_RXC )) _interrupt->raise( rx );
+					//
+					//	Interrupts disabled while still pending
+					//	are withdrawn.
+					//
+					if(( was & ~_ucsrb ) & SerialDevice::ucsrb_UDRIE ) _interrupt->clear( dre );
+					if(( was & ~_ucsrb ) & SerialDevice::ucsrb_RXCIE ) _interrupt->clear( rx );
+					if(( was & ~_ucsrb ) & SerialDevice::ucsrb_TXCIE ) _interrupt->clear( tx );
 					break;
 				}
 				case SerialDevice::UCSRnC: {
+					_ucsrc = value;
 					reset_char_bits();
 					reset_stop_bits();
+					reset_clock_target();
 					break;
 				}
 				case SerialDevice::UBRRnL: {
@@ -428,26 +531,46 @@ template< byte rx, byte dre, byte tx > class SerialDriver : public SerialDevice
 			return( false );
 		}
 		//
-		//	The Clock ticking API
+		//	The Clock event API
 		//
-		virtual void tick( word handle, bool inst_end ) {
+		virtual void event( word handle ) {
 			switch( handle ) {
-				case System_Clock: {
-					if( _ucsrb & SerialDevice::ucsrb_RXEN ) {
-						if( _input_clock_count ) {
-							_input_clock_count--;
-						}
+				case SerialDevice::Transmit_Frame: {
+					//
+					//	The byte in the shift register has
+					//	gone; send the next if there is one,
+					//	otherwise the transmission is complete.
+					//
+					_target->write( _shift );
+					_sending = false;
+					if(( _ucsrb & SerialDevice::ucsrb_TXEN ) && !( _ucsra & SerialDevice::ucsra_UDRE )) {
+						send_frame();
 					}
-					if( _ucsrb & SerialDevice::ucsrb_TXEN ) {
-						if( _output_clock_count ) {
-							_output_clock_count--;
-							_target->write( _trans_buffer );
-							_ucsra |= SerialDevice::ucsra_UDRE;
-							if( _ucsrb & SerialDevice::ucsrb_UDRIE ) _interrupt->raise( dre, &_ucsra, SerialDevice::ucsra_UDRE );
-						}
+					else {
+						_ucsra |= SerialDevice::ucsra_TXC;
+						if( _ucsrb & SerialDevice::ucsrb_TXCIE ) _interrupt->raise( tx, &_ucsra, SerialDevice::ucsra_TXC );
+					}
+					break;
+				}
+				case SerialDevice::Receive_Frame: {
+					byte	c;
+
+					//
+					//	The byte has arrived.  The next is
+					//	timed once this has been read from
+					//	the receive buffer.
+					//
+					if(!( _ucsra & SerialDevice::ucsra_RXC ) && _target->read( &c )) {
+						_recv_buffer = c;
+						_ucsra |= SerialDevice::ucsra_RXC;
+						if( _ucsrb & SerialDevice::ucsrb_RXCIE ) _interrupt->raise( rx );
 					}
 					break;
 				}
+				case SerialDevice::Input_Supplied: {
+					receive_next();
+					break;
+				}
 				default: {
 					ABORT();
 					break;
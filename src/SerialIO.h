@@ -10,6 +10,8 @@
 
 #include <stdio.h>
 
+#include "Clock.h"
+
 class SerialIO {
 	public:
 		//
@@ -24,6 +26,13 @@ class SerialIO {
 		//
 		virtual void display( FILE *to ) = 0;
 		virtual void supply( char c ) = 0;
+		//
+		//	The device reading the input is told, through
+		//	its event 'handle', each time input is supplied,
+		//	and can ask if any is waiting to be read.
+		//
+		virtual void attach( Event *reader, word handle ) = 0;
+		virtual bool waiting( void ) = 0;
 };
 
 #endif
@@ -40,6 +40,12 @@ template< int rows, int cols > class SerialTerminal : public SerialIO {
 		char	_out_buf[ out_buf ];	// data leaving terminal
 		int	_pending;		// and amount left to send.
 
+		//
+		//	Who to tell when data is supplied.
+		//
+		Event	*_reader;
+		word	_handle;
+
 		//
 		//	Where control codes are gathered.
 		//
@@ -155,6 +161,8 @@ template< int rows, int cols > class SerialTerminal : public SerialIO {
 			_row = 0;
 			_col = 0;
 			_pending = 0;
+			_reader = NULL;
+			_handle = 0;
 			_waiting = 0;
 			_escaped = false;
 			_bottom = false;
@@ -283,7 +291,17 @@ template< int rows, int cols > class SerialTerminal : public SerialIO {
 			}
 		}
 		virtual void supply( char c ) {
-			if( _pending < out_buf ) _out_buf[ _pending++ ] = c;
+			if( _pending < out_buf ) {
+				_out_buf[ _pending++ ] = c;
+				if( _reader ) _reader->event( _handle );
+			}
+		}
+		virtual void attach( Event *reader, word handle ) {
+			_reader = reader;
+			_handle = handle;
+		}
+		virtual bool waiting( void ) {
+			return( _pending > 0 );
 		}
 
 };
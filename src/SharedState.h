@@ -0,0 +1,187 @@
+//
+//	SharedState.h
+//	=============
+//
+//	Export of the live state of the simulated MCU through a
+//	POSIX shared memory segment, so that other processes can
+//	watch it without stopping the simulation.
+//
+//	The segment layout (all values little endian, offsets in
+//	bytes) is:
+//
+//	Offset	Size	Content
+//	------	----	-------
+//	0	4	Magic number, the characters "SAVR"
+//	4	4	Layout version (1)
+//	8	4	Sequence counter
+//	12	4	Total size of the segment
+//	16	8	Clock cycles since reset
+//	24	4	PC (a word address)
+//	28	2	SP
+//	30	1	SREG
+//	31	1	Number of pins (P, at most 64)
+//	32	32	Registers R0 to R31
+//	64	2	Data space address of the first SRAM byte
+//	66	2	Size of the SRAM in bytes (S)
+//	68	60	Reserved (0)
+//	128	64	Pin states, one byte for each of the P pins
+//		(pin 0 first):
+//
+//			bit 0	PIN, the level seen on the pin
+//			bit 1	DDR, set when the pin is an output
+//			bit 2	PORT, the output level or pull up
+//
+//	192	S	SRAM content
+//
+//	The state is copied into the segment whenever it is
+//	published.  The sequence counter is odd while this is
+//	under way and even once it is complete, so a reader
+//	takes a consistent snapshot by:
+//
+//		1/ Reading the sequence counter, and waiting for
+//		   it to be even.
+//		2/ Copying what it needs from the segment.
+//		3/ Reading the sequence counter again; if it has
+//		   changed the copy is discarded and taken again.
+//
+
+#ifndef _SHARED_STATE_H_
+#define _SHARED_STATE_H_
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Base.h"
+#include "Reporter.h"
+
+class SharedState {
+	public:
+		//
+		//	The layout constants.
+		//
+		static const dword share_magic		= 0x52564153;	// "SAVR"
+		static const dword share_version	= 1;
+		static const word max_pins		= 64;
+		static const word share_header		= 192;
+
+		//
+		//	Pin state bits.
+		//
+		static const byte pin_PIN		= BIT( byte, 0 );
+		static const byte pin_DDR		= BIT( byte, 1 );
+		static const byte pin_PORT		= BIT( byte, 2 );
+
+		//
+		//	The segment header, laid out as above.
+		//
+		struct layout {
+			dword		magic,
+					version;
+			volatile dword	sequence;
+			dword		size,
+					cycles[ 2 ],
+					pc;
+			word		sp;
+			byte		sreg,
+					pins,
+					reg[ 32 ];
+			word		sram_base,
+					sram_size;
+			byte		reserved[ 60 ],
+					pin[ max_pins ];
+		};
+
+	private:
+		//
+		//	Where reports go...
+		//
+		Reporter	*_report;
+		int		_instance;
+
+		//
+		//	The segment, mapped, and its size.
+		//
+		layout		*_share;
+		dword		_size;
+
+	public:
+		SharedState( Reporter *report, int instance ) {
+			_report = report;
+			_instance = instance;
+			_share = NULL;
+			_size = 0;
+		}
+		~SharedState() {
+			if( _share ) munmap( _share, _size );
+		}
+
+		//
+		//	Create (or re-use) the named segment sized to hold
+		//	'sram' bytes of SRAM and 'pins' pins, and fill in
+		//	its fixed details.  Returns false (having reported
+		//	why) on failure.
+		//
+		bool open( const char *name, word sram_base, word sram_size, byte pins ) {
+			int	fd;
+			void	*at;
+
+			ASSERT( _share == NULL );
+			ASSERT( sizeof( layout ) == share_header );
+
+			if( pins > max_pins ) pins = max_pins;
+			_size = share_header + sram_size;
+			if(( fd = shm_open( name, O_RDWR | O_CREAT, 0644 )) < 0 ) {
+				_report->report( Error_Level, Share_Module, _instance, File_Open_Failed, "Unable to open shared memory '%s'", name );
+				return( false );
+			}
+			if( ftruncate( fd, _size ) < 0 ) {
+				_report->report( Error_Level, Share_Module, _instance, File_Open_Failed, "Unable to size shared memory '%s'", name );
+				close( fd );
+				return( false );
+			}
+			at = mmap( NULL, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+			close( fd );
+			if( at == MAP_FAILED ) {
+				_report->report( Error_Level, Share_Module, _instance, File_Open_Failed, "Unable to map shared memory '%s'", name );
+				return( false );
+			}
+			_share = (layout *)at;
+			memset( _share, 0, _size );
+			_share->magic = share_magic;
+			_share->version = share_version;
+			_share->size = _size;
+			_share->pins = pins;
+			_share->sram_base = sram_base;
+			_share->sram_size = sram_size;
+			_report->report( Information_Level, Share_Module, _instance, Config_Change, "State shared through '%s' (%d bytes)", name, (int)_size );
+			return( true );
+		}
+
+		//
+		//	Bracket an update of the segment; between these
+		//	the content can be filled in through state() and
+		//	sram().
+		//
+		void begin( void ) {
+			_share->sequence++;
+			__sync_synchronize();
+		}
+		void end( void ) {
+			__sync_synchronize();
+			_share->sequence++;
+		}
+		layout *state( void ) {
+			return( _share );
+		}
+		byte *sram( void ) {
+			return( (byte *)_share + share_header );
+		}
+};
+
+#endif
+
+//
+//	EOF
+//
@@ -85,7 +85,7 @@ class Symbols {
 		//
 		//	Find a label record by either name or value.
 		//
-		label *find_label( symbol_type type, char *name ) {
+		label *find_label( symbol_type type, const char *name ) {
 			label	*look;
 
 			for( look = _by_name; look; look = look->next_by_name ) {
@@ -372,6 +372,31 @@ class Symbols {
 			return( constant( type, value, buffer, max ));
 		}
 
+		//
+		//	Return the name of the label (of a type) nearest to,
+		//	and not above, a value, with its value, or NULL if
+		//	there is none.
+		//
+		const char *nearest( symbol_type type, dword value, dword *at ) {
+			label	*look;
+
+			if(( look = find_nearest( type, value )) == NULL ) return( NULL );
+			*at = look->value;
+			return( look->name );
+		}
+
+		//
+		//	Look up the value of a label (of a type) by name,
+		//	returning false if there is no such label.
+		//
+		bool lookup( symbol_type type, const char *name, dword *at ) {
+			label	*look;
+
+			if(( look = find_label( type, name )) == NULL ) return( false );
+			*at = look->value;
+			return( true );
+		}
+
 		//
 		//	Offer a mechanism for converting an EOS terminated
 		//	string into an actual value.  This needs to be provided
@@ -4,6 +4,15 @@
 //
 //	The definition and implementation of a timer.
 //
+//	A timer is not ticked by the clock.  Instead it works out
+//	how many prescaled clocks will pass before its count next
+//	reaches a value at which something other than counting
+//	can happen (an overflow, compare match, OCR update or
+//	change of direction) and schedules a clock event for
+//	then.  In between, the count is only brought up to date
+//	when it is needed: as TCNTn is read, or before any timer
+//	register is written (after which the event is re-timed).
+//
 
 #ifndef _TIMER_H_
 #define _TIMER_H_
@@ -23,7 +32,7 @@
 //	This is the generic timer class that can be handled in
 //	in a non-specific manner.
 //
-class Timer : public Tick, Notification {
+class Timer : public Event, public Notification {
 	protected:
 		//
 		//	Note down where we send reports and interrupts.
@@ -31,6 +40,11 @@ class Timer : public Tick, Notification {
 		Reporter	*_report;
 		Interrupts	*_interrupt;
 
+		//
+		//	The clock driving the timer.
+		//
+		Clock		*_crystal;
+
 		//
 		//	Define the individual bits which this timers test or set.
 		//
@@ -184,7 +198,7 @@ class Timer : public Tick, Notification {
 		//
 		inline byte high_byte( word value ) { return( value >> 8 ); }
 		inline byte low_byte( word value ) { return( value ); }
-		inline word high_low( byte hi, byte lo ) { return(( (word)hi << 8 )||((word)lo )); }
+		inline word high_low( byte hi, byte lo ) { return(( (word)hi << 8 )|((word)lo )); }
 
 
 	public:
@@ -233,24 +247,25 @@ class Timer : public Tick, Notification {
 		//
 		//	Common constructor.
 		//
-		Timer( Reporter *channel, Interrupts *handler ) {
+		Timer( Reporter *channel, Interrupts *handler, Clock *crystal ) {
 			_report = channel;
 			_interrupt = handler;
+			_crystal = crystal;
 		}
 
 		//
-		//	This is our handle for the system clock.
+		//	This is our handle for the clock event.
 		//
-		static const word System_Clock = 0;
+		static const word Timer_Step = 0;
 
 		//
-		//	(Clock) Tick API
-		//	================
+		//	(Clock) Event API
+		//	=================
 		//
-		//	Called once for every tick which the
-		//	clock is simulating.
+		//	Called as the count reaches the next value at
+		//	which the timer has to act.
 		//
-		virtual void tick( word id, bool inst_end ) = 0;
+		virtual void event( word id ) = 0;
 
 		//
 		//	Notification API
@@ -302,6 +317,14 @@ template< int instance, bool eight_bit, byte compa, byte compb, byte ovrf, byte
 		word		_counter;		// The pre-scaling counter.
 		bool		_skip_match,
 				_countdown;
+
+		//
+		//	The clock event for the next step at which the timer
+		//	acts, and the number of clock cycles between the last
+		//	time the count was brought up to date and that event.
+		//
+		word		_step_event;
+		qword		_armed;
 		
 		//
 		//	Define elements of the configuration as extracted from
@@ -347,7 +370,7 @@ template< int instance, bool eight_bit, byte compa, byte compb, byte ovrf, byte
 		//
 		//	Build a new timer device!
 		//
-		TimerDevice( Reporter *channel, Interrupts *handler ) : Timer( channel, handler ) {
+		TimerDevice( Reporter *channel, Interrupts *handler, Clock *crystal ) : Timer( channel, handler, crystal ) {
 			_tcnt = 0;
 			_ocra = 0; _pending_ocra = 0;
 			_ocrb = 0; _pending_ocrb = 0;
@@ -368,95 +391,217 @@ template< int instance, bool eight_bit, byte compa, byte compb, byte ovrf, byte
 			_counter = 0;
 			_skip_match = false;
 			_countdown = false;
+
+			_step_event = crystal->event( Timer_Step, this, Clock::IO_Domain );
+			_armed = 0;
+
+			//
+			//	The 16 bit registers go through the TEMP
+			//	register so are hooked both ways.  The
+			//	control registers are read directly but
+			//	their writes reconfigure the timer.
+			//
+			declare( OCRnBH, NULL, Hooked_Register );
+			declare( OCRnBL, NULL, Hooked_Register );
+			declare( OCRnAH, NULL, Hooked_Register );
+			declare( OCRnAL, NULL, Hooked_Register );
+			declare( ICRnH, NULL, Hooked_Register );
+			declare( ICRnL, NULL, Hooked_Register );
+			declare( TCNTnH, NULL, Hooked_Register );
+			declare( TCNTnL, NULL, Hooked_Register );
+			declare( TCCRnC, &_tccrc, Write_Hook );
+			declare( TCCRnB, &_tccrb, Write_Hook );
+			declare( TCCRnA, &_tccra, Write_Hook );
+			//
+			//	Timer Interrupt Flags
+			//
+			//		7	6	5	4	3	2	1	0
+			//	TIFRn	-	-	ICFn	-	–	OCFnB	OCFnA	TOVn
+			//		0	0	r/w	0	0	r/w	r/w	r/w
+			//
+			declare( TIFRn, &_tifr, Read_Only_Register );
+			//
+			//	Timer Interrupt Mask
+			//
+			//		7	6	5	4	3	2	1	0
+			//	TIMSKn	-	-	ICIEn	-	–	OCIEnB	OCIEnA	TOIEn
+			//		0	0	r/w	0	0	r/w	r/w	r/w
+			//
+			declare( TIMSKn, &_timsk, Plain_Register );
 		}
 
 		//
-		//	(Clock) Tick API
-		//	================
-		//
-		//	Called once for every tick which the
-		//	clock is simulating.
+		//	Move the count on by one prescaled clock, and then
+		//	act on the value it has reached.
 		//
-		virtual void tick( word id, UNUSED( bool end_inst )) {
-			ASSERT( id == System_Clock );
-			if( _clock->running ) {
-				if( _clock->external ) {
-					//
-					//	Not implemented yet - produce no output as its
-					//	pointless.
-					//
+		void step( void ) {
+			if( _waveform->up_down ) {
+				//
+				//	Doing a saw-tooth counter..
+				//
+				if( _countdown ) {
+					if( _tcnt > 0 ) {
+						_tcnt -= 1;
+					}
+					else {
+						_countdown = false;
+						_tcnt += 1;
+					}
 				}
 				else {
-					if(( _counter += 1 ) >= _clock->prescaler ) {
-						_counter = 0;
-						//
-						//	Increment/decrement the pre-scaled counter.
-						//
-						if( _waveform->up_down ) {
-							//
-							//	Doing a saw-tooth counter..
-							//
-							if( _countdown ) {
-								if( _tcnt > 0 ) {
-									_tcnt -= 1;
-								}
-								else {
-									_countdown = false;
-									_tcnt += 1;
-								}
-							}
-							else {
-								if( _tcnt < *_loop_on ) {
-									_tcnt += 1;
-								}
-								else {
-									_countdown = true;
-									_tcnt -= 1;
-								}
-							}
-						}
-						else {
-							//
-							//	Doing a triangle counter
-							//
-							if( _tcnt < *_loop_on ) {
-								_tcnt += 1;
-							}
-							else {
-								_countdown = false;
-								_tcnt = 0;
-							}
-						}
-						//
-						//	Now we check for various conditions and
-						//	implement the appropriate action in the
-						//	event of a suitable match.
-						//
-						if( do_action( _waveform->set_ocr, _ocra )) {
-							if( _ocra != _pending_ocra ) {
-								_report->report( Information_Level, Timer_Module, instance, Config_Change, "OCR%dA = %d (from %d )", instance, (int)_pending_ocra, (int)_ocra );
-								_ocra = _pending_ocra;
-							}
-							if( _ocrb != _pending_ocrb ) {
-								_report->report( Information_Level, Timer_Module, instance, Config_Change, "OCR%dA = %d (from %d )", instance, (int)_pending_ocra, (int)_ocra );
-								_ocrb = _pending_ocrb;
-							}
-						}
-						if( do_action( _waveform->set_tov, _ocra )) {
-							_tifr |= bit_TOVn;
-							if( _timsk & bit_TOIEn ) _interrupt->raise( ovrf, &_tifr, bit_TOVn );
-						}
-						if(( _timsk & bit_OCIEnA )&&( _tcnt == _ocra )) {
-							_tifr |= bit_OCFnA;
-							_interrupt->raise( compa, &_tifr, bit_OCFnA );
-						}
-						if(( _timsk & bit_OCIEnB )&&( _tcnt == _ocrb )) {
-							_tifr |= bit_OCFnB;
-							_interrupt->raise( compb, &_tifr, bit_OCFnB );
-						}
+					if( _tcnt < *_loop_on ) {
+						_tcnt += 1;
+					}
+					else {
+						_countdown = true;
+						_tcnt -= 1;
 					}
 				}
 			}
+			else {
+				//
+				//	Doing a triangle counter
+				//
+				if( _tcnt < *_loop_on ) {
+					_tcnt += 1;
+				}
+				else {
+					_countdown = false;
+					_tcnt = 0;
+				}
+			}
+			//
+			//	Now we check for various conditions and
+			//	implement the appropriate action in the
+			//	event of a suitable match.
+			//
+			if( do_action( _waveform->set_ocr, _ocra )) {
+				if( _ocra != _pending_ocra ) {
+					_report->report( Information_Level, Timer_Module, instance, Config_Change, "OCR%dA = %d (from %d )", instance, (int)_pending_ocra, (int)_ocra );
+					_ocra = _pending_ocra;
+				}
+				if( _ocrb != _pending_ocrb ) {
+					_report->report( Information_Level, Timer_Module, instance, Config_Change, "OCR%dA = %d (from %d )", instance, (int)_pending_ocra, (int)_ocra );
+					_ocrb = _pending_ocrb;
+				}
+			}
+			if( do_action( _waveform->set_tov, _ocra )) {
+				_tifr |= bit_TOVn;
+				if( _timsk & bit_TOIEn ) _interrupt->raise( ovrf, &_tifr, bit_TOVn );
+			}
+			if(( _timsk & bit_OCIEnA )&&( _tcnt == _ocra )) {
+				_tifr |= bit_OCFnA;
+				_interrupt->raise( compa, &_tifr, bit_OCFnA );
+			}
+			if(( _timsk & bit_OCIEnB )&&( _tcnt == _ocrb )) {
+				_tifr |= bit_OCFnB;
+				_interrupt->raise( compb, &_tifr, bit_OCFnB );
+			}
+		}
+
+		//
+		//	Return the number of prescaled clocks, from the
+		//	current count, until (and including) the first after
+		//	which the timer might do anything other than count:
+		//	a change of direction, or the count reaching a value
+		//	on which an action depends.
+		//
+		static void nearer( word *steps, word n ) {
+			if( n < *steps ) *steps = n;
+		}
+		word steps_to_action( void ) {
+			word	top,
+				n;
+
+			if(( _waveform->set_tov == At_Imm )||(( _waveform->set_ocr == At_Imm )&&(( _ocra != _pending_ocra )||( _ocrb != _pending_ocrb )))) return( 1 );
+			top = *_loop_on;
+			if( _waveform->up_down && _countdown ) {
+				//
+				//	Counting down to zero.
+				//
+				if(( n = _tcnt ) == 0 ) return( 1 );
+				if( top < _tcnt ) nearer( &n, _tcnt - top );
+				if( _waveform->maximum < _tcnt ) nearer( &n, _tcnt - _waveform->maximum );
+				if( _ocra < _tcnt ) nearer( &n, _tcnt - _ocra );
+				if( _ocrb < _tcnt ) nearer( &n, _tcnt - _ocrb );
+				return( n );
+			}
+			//
+			//	Counting up to the top.
+			//
+			if( _tcnt >= top ) return( 1 );
+			n = top - _tcnt;
+			if( _waveform->maximum > _tcnt ) nearer( &n, _waveform->maximum - _tcnt );
+			if( _ocra > _tcnt ) nearer( &n, _ocra - _tcnt );
+			if( _ocrb > _tcnt ) nearer( &n, _ocrb - _tcnt );
+			return( n );
+		}
+
+		//
+		//	Bring the count up to date with the clock, leaving
+		//	the last 'hold' prescaled clocks (which the caller
+		//	will step through itself) uncounted.  None of the
+		//	clocks counted here can be one at which the timer
+		//	acts, so the count simply moves on in a straight
+		//	line.
+		//
+		void sync( word hold ) {
+			qword	total,
+				steps;
+
+			if( _crystal->pending( _step_event )) {
+				total = _armed - _crystal->due( _step_event );
+				_armed -= total;
+			}
+			else {
+				total = _armed;
+				_armed = 0;
+			}
+			if( total == 0 ) return;
+			total += _counter;
+			steps = total / _clock->prescaler;
+			_counter = total % _clock->prescaler;
+			ASSERT( steps >= hold );
+			steps -= hold;
+			if( _waveform->up_down && _countdown ) {
+				_tcnt -= steps;
+			}
+			else {
+				_tcnt += steps;
+			}
+		}
+
+		//
+		//	Schedule the clock event for the next step at which
+		//	the timer acts (if it is counting).
+		//
+		void rearm( void ) {
+			if( !_clock->running || _clock->external ) {
+				//
+				//	An external clock source is not implemented
+				//	yet, so produces no output.
+				//
+				_crystal->cancel( _step_event );
+				_armed = 0;
+				return;
+			}
+			if( _counter >= _clock->prescaler ) _counter = _clock->prescaler - 1;
+			_armed = (qword)( steps_to_action() - 1 ) * _clock->prescaler + ( _clock->prescaler - _counter );
+			_crystal->schedule( _step_event, _armed );
+		}
+
+		//
+		//	(Clock) Event API
+		//	=================
+		//
+		//	Called as the count reaches the next value at
+		//	which the timer has to act.
+		//
+		virtual void event( word id ) {
+			ASSERT( id == Timer_Step );
+			sync( 1 );
+			step();
+			rearm();
 		}
 
 		//
@@ -490,6 +635,7 @@ template< int instance, bool eight_bit, byte compa, byte compb, byte ovrf, byte
 					return( _temp );
 				}
 				case TCNTnL: {
+					sync( 0 );
 					_temp = high_byte( _tcnt );
 					return( low_byte( _tcnt ));
 				}
@@ -502,21 +648,6 @@ template< int instance, bool eight_bit, byte compa, byte compb, byte ovrf, byte
 					_temp = high_byte( _icr );
 					return( low_byte( _icr ));
 				}
-				case TCCRnC: {
-					return( _tccrc );
-				}
-				case TCCRnB: {
-					return( _tccrb );
-				}
-				case TCCRnA: {
-					return( _tccra );
-				}
-				case TIFRn: {
-					return( _tifr );
-				}
-				case TIMSKn: {
-					return( _timsk );
-				}
 				default: {
 					ABORT();
 					break;
@@ -525,6 +656,11 @@ template< int instance, bool eight_bit, byte compa, byte compb, byte ovrf, byte
 			return( 0 );
 		}
 		virtual void write_register( word id, byte value )  {
+			//
+			//	Count up to now under the configuration
+			//	being replaced.
+			//
+			sync( 0 );
 			switch( id ) {
 				case OCRnBH: {
 					ASSERT( !eight_bit );
@@ -678,31 +814,16 @@ template< int instance, bool eight_bit, byte compa, byte compb, byte ovrf, byte
 					_report->report( Information_Level, Timer_Module, instance, Config_Change, _waveform->desc, instance );
 					break;
 				}
-				case TIFRn: {
-					//
-					//	Timer Interrupt Flags
-					//
-					//		7	6	5	4	3	2	1	0
-					//	TIFRn	-	-	ICFn	-	–	OCFnB	OCFnA	TOVn
-					//		0	0	r/w	0	0	r/w	r/w	r/w
-					//
-					break;
-				}
-				case TIMSKn: {
-					//
-					//	Timer Interrupt Mask
-					//
-					//		7	6	5	4	3	2	1	0
-					//	TIMSKn	-	-	ICIEn	-	–	OCIEnB	OCIEnA	TOIEn
-					//		0	0	r/w	0	0	r/w	r/w	r/w
-					//
-					break;
-				}
 				default: {
 					ABORT();
 					break;
 				}
 			}
+			//
+			//	Re-time the next step at which the timer acts
+			//	under the new configuration.
+			//
+			rearm();
 		}	
 		//
 		//	Mechanism for examining content outside the
@@ -722,6 +843,7 @@ template< int instance, bool eight_bit, byte compa, byte compb, byte ovrf, byte
 				}
 				case TCNTnH:
 				case TCNTnL: {
+					sync( 0 );
 					snprintf( buffer, max, "TCNT%d = %d", instance, (int)_tcnt );
 					return( true );
 				}
@@ -0,0 +1,233 @@
+//
+//	WatchPoint.h
+//	============
+//
+//
+//	A simple class for managing storage and checking of data
+//	space watch points.
+//
+//	Every watched address is marked in a shadow map holding,
+//	for each address of the data space, the kinds of access
+//	being watched there.  Checking an access is then a single
+//	indexed look up however many watch points are set, and the
+//	list of watch points is only searched once one is hit.
+//
+
+#ifndef _WATCH_POINT_H_
+#define _WATCH_POINT_H_
+
+#include "Base.h"
+
+class WatchPoint {
+	public:
+		//
+		//	The kinds of access which can be watched.  A change
+		//	watch is triggered by a write which alters the value
+		//	held at an address.
+		//
+		static const byte Watch_Read	= BIT( byte, 0 );
+		static const byte Watch_Write	= BIT( byte, 1 );
+		static const byte Watch_Change	= BIT( byte, 2 );
+		static const byte Watch_Any	= Watch_Read | Watch_Write | Watch_Change;
+
+	private:
+		//
+		//	Define the structure we will use to keep watch points
+		//
+		struct watchpoint {
+			int		index;
+			dword		starts,
+					ends;
+			byte		kinds;
+			dword		hits;
+			watchpoint	*next;
+		};
+		//
+		//	This is the active list of watch points
+		//
+		watchpoint		*_active;
+		//
+		//	This is the list of reusable records.
+		//
+		watchpoint		*_inactive;
+		//
+		//	This is the next available watch point
+		//	number.
+		//
+		int			_next;
+
+		//
+		//	The shadow map, one byte of watched access kinds
+		//	per data space address.
+		//
+		static const dword shadow_size = 0x10000;
+		byte			*_shadow;
+
+		//
+		//	Details of the most recent hit.
+		//
+		int			_hit;
+		word			_hit_adrs;
+		byte			_hit_kind,
+					_hit_value;
+
+		//
+		//	Rebuild the shadow map from the active list.
+		//
+		void shadow( void ) {
+			for( dword a = 0; a < shadow_size; _shadow[ a++ ] = 0 );
+			for( watchpoint *p = _active; p != NULL; p = p->next ) {
+				for( dword a = p->starts; ( a < p->ends )&&( a < shadow_size ); a++ ) _shadow[ a ] |= p->kinds;
+			}
+		}
+
+	public:
+		WatchPoint( void ) {
+			_active = NULL;
+			_inactive = NULL;
+			_next = 1;
+			_shadow = new byte[ shadow_size ];
+			for( dword a = 0; a < shadow_size; _shadow[ a++ ] = 0 );
+			_hit = 0;
+			_hit_adrs = 0;
+			_hit_kind = 0;
+			_hit_value = 0;
+		}
+		//
+		//	Define the basic watch point API.
+		//
+		//
+		//	Return true if any of the access kinds given
+		//	are being watched at an address.
+		//
+		inline bool watched( word adrs, byte kinds ) {
+			return(( _shadow[ adrs ] & kinds ) != 0 );
+		}
+		//
+		//	Note an access of the kinds given (a write can also be
+		//	a change) to a watched address, returning true if a
+		//	watch point has been triggered.  The lowest numbered
+		//	watch point covering the access is recorded as hit.
+		//
+		bool trigger( word adrs, byte kinds, byte value ) {
+			watchpoint *w;
+
+			if(!( kinds &= _shadow[ adrs ])) return( false );
+			w = NULL;
+			for( watchpoint *p = _active; p != NULL; p = p->next ) {
+				if(( adrs >= p->starts )&&( adrs < p->ends )&&( p->kinds & kinds )) {
+					if(( w == NULL )||( p->index < w->index )) w = p;
+				}
+			}
+			if( w == NULL ) return( false );
+			w->hits++;
+			_hit = w->index;
+			_hit_adrs = adrs;
+			_hit_kind = w->kinds & kinds;
+			_hit_value = value;
+			return( true );
+		}
+		//
+		//	Return the number of the watch point last hit (0 if
+		//	none), with or without the details of the access.
+		//
+		int triggered( void ) {
+			return( _hit );
+		}
+		int last( word *adrs, byte *kinds, byte *value ) {
+			*adrs = _hit_adrs;
+			*kinds = _hit_kind;
+			*value = _hit_value;
+			return( _hit );
+		}
+		//
+		//	Add a new watch point on the addresses from 'starts'
+		//	up to (but not including) 'ends' and return its
+		//	number or 0 on failure.
+		//
+		//	Unlike break points, watch points are never merged
+		//	as overlapping ranges may be watching for different
+		//	kinds of access.
+		//
+		int add( dword starts, dword ends, byte kinds ) {
+			watchpoint *p;
+
+			ASSERT( starts < ends );
+			if(( kinds &= Watch_Any ) == 0 ) return( 0 );
+			if( starts >= shadow_size ) return( 0 );
+			if(( p = _inactive )) {
+				_inactive = _inactive->next;
+			}
+			else {
+				p = new watchpoint;
+			}
+			p->index = _next++;
+			p->starts = starts;
+			p->ends = ( ends > shadow_size )? shadow_size: ends;
+			p->kinds = kinds;
+			p->hits = 0;
+			p->next = _active;
+			_active = p;
+			shadow();
+			return( p->index );
+		}
+		//
+		//	Delete a numbered watch point.
+		//
+		bool remove( int number ) {
+			watchpoint *p, **a;
+
+			for( a = &_active; ( p = *a ) != NULL; a = &( p->next )) {
+				if( number == p->index ) {
+					*a = p->next;
+					p->next = _inactive;
+					_inactive = p;
+					shadow();
+					return( true );
+				}
+			}
+			return( false );
+		}
+		//
+		//	Return the details of a numbered watch point.
+		//
+		bool address( int number, dword *starts, dword *ends, byte *kinds, dword *hits ) {
+			for( watchpoint *p = _active; p != NULL; p = p->next ) {
+				if( number == p->index ) {
+					*starts = p->starts;
+					*ends = p->ends;
+					*kinds = p->kinds;
+					*hits = p->hits;
+					return( true );
+				}
+			}
+			return( false );
+		}
+		//
+		//	Finally, generate a list of all current watch points
+		//
+		int list( int *array, int max ) {
+			int count = 0;
+
+			for( watchpoint *p = _active; ( p != NULL )&&( count < max ); p = p->next ) array[ count++ ] = p->index;
+			return( count );
+		}
+		//
+		//	Convert a set of access kinds into a short piece
+		//	of text ("rwc" with dashes for those absent).
+		//
+		static const char *kind_text( byte kinds, char *buffer ) {
+			buffer[ 0 ] = ( kinds & Watch_Read )? 'r': '-';
+			buffer[ 1 ] = ( kinds & Watch_Write )? 'w': '-';
+			buffer[ 2 ] = ( kinds & Watch_Change )? 'c': '-';
+			buffer[ 3 ] = EOS;
+			return( buffer );
+		}
+};
+
+
+#endif
+
+//
+//	EOF
+//
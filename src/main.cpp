@@ -38,6 +38,7 @@
 #include "Timer.h"
 #include "DeviceRegister.h"
 #include "BreakPoint.h"
+#include "WatchPoint.h"
 #include "Pin.h"
 #include "AnalogueConversion.h"
 #include "Port.h"
@@ -45,6 +46,7 @@
 #include "SerialTerminal.h"
 #include "Factory.h"
 #include "Coverage.h"
+#include "HeatMap.h"
 
 //
 //	Define global environment factory.
@@ -222,17 +224,13 @@ static CPU *atmega328p( Reporter *channel, Coverage *tracker, const char *load,
 					//
 					//	The USART
 					//
-	SerialDevice *serial		= new SerialDriver<19,20,21>( channel, 0, irq_router, make->serial_io( 0 ));
+	SerialDevice *serial		= new SerialDriver<19,20,21>( channel, 0, irq_router, make->serial_io( 0 ), crystal );
 						ports->segment( new DeviceRegister( serial, SerialDevice::UDRn ), EXT_IO( 0xC6 ));
 						ports->segment( new DeviceRegister( serial, SerialDevice::UBRRnH ), EXT_IO( 0xC5 ));
 						ports->segment( new DeviceRegister( serial, SerialDevice::UBRRnL ), EXT_IO( 0xC4 ));
 						ports->segment( new DeviceRegister( serial, SerialDevice::UCSRnC ), EXT_IO( 0xC2 ));
 						ports->segment( new DeviceRegister( serial, SerialDevice::UCSRnB ), EXT_IO( 0xC1 ));
 						ports->segment( new DeviceRegister( serial, SerialDevice::UCSRnA ), EXT_IO( 0xC0 ));
-						//
-						//	Needs an understanding of time...
-						//
-						crystal->add( SerialDevice::System_Clock, (Tick *)serial );
 
 					//
 					//	Declare the processor core.
@@ -253,12 +251,11 @@ static CPU *atmega328p( Reporter *channel, Coverage *tracker, const char *load,
 						ports->segment( new DeviceRegister( (Notification *)processor, AVR_CPU::RAMD ), 0x38 );
 						ports->segment( new DeviceRegister( (Notification *)processor, AVR_CPU::MCUCR ), 0x35 );
 						ports->segment( new DeviceRegister( (Notification *)processor, AVR_CPU::MCUSR ), 0x34 );
+						ports->segment( new DeviceRegister( (Notification *)processor, AVR_CPU::SMCR ), 0x33 );
 						//
-						//	The processor sees a WDT clock at 128 KHz.
+						//	The system clock prescaler.
 						//
 						ports->segment( new DeviceRegister( (Notification *)crystal, Clock::CLKPR ), EXT_IO( 0x61 ));
-						crystal->add( AVR_CPU::System_Clock, (Tick *)processor );
-						crystal->add( AVR_CPU::WDT_Clock, (Tick *)processor, 128 );
 
 					//
 					//	Timer 0, the first 8 bit timer.
@@ -267,7 +264,7 @@ static CPU *atmega328p( Reporter *channel, Coverage *tracker, const char *load,
 					//	16	0x00F TIMER0_COMPB Timer/Counter0 Compare Match B
 					//	17	0x010 TIMER0_OVF Timer/Counter0 Overflow
 					// 
-	Timer		*timer0		= new TimerDevice< 0, true, 15, 16, 17, 0 >( channel, irq_router );
+	Timer		*timer0		= new TimerDevice< 0, true, 15, 16, 17, 0 >( channel, irq_router, crystal );
 						ports->segment( new DeviceRegister( (Notification *)timer0, Timer::TIMSKn ), EXT_IO( 0x6E ));
 						ports->segment( new DeviceRegister( (Notification *)timer0, Timer::OCRnB ), 0x28 );
 						ports->segment( new DeviceRegister( (Notification *)timer0, Timer::OCRnA ), 0x27 );
@@ -275,7 +272,6 @@ static CPU *atmega328p( Reporter *channel, Coverage *tracker, const char *load,
 						ports->segment( new DeviceRegister( (Notification *)timer0, Timer::TCCRnB ), 0x25 );
 						ports->segment( new DeviceRegister( (Notification *)timer0, Timer::TCCRnA ), 0x24 );
 						ports->segment( new DeviceRegister( (Notification *)timer0, Timer::TIFRn ), 0x15 );
-						crystal->add( Timer::System_Clock, timer0 );
 
 					//
 					//	Timer 1, the 16 bit timer.
@@ -285,7 +281,7 @@ static CPU *atmega328p( Reporter *channel, Coverage *tracker, const char *load,
 					//	13	0x00C TIMER1_COMPB Timer/Counter1 Compare Match B
 					//	14	0x00D TIMER1_OVF Timer/Counter1 Overflow
 					//
-	Timer		*timer1		= new TimerDevice< 1, false, 12, 13, 14, 11 >( channel, irq_router );
+	Timer		*timer1		= new TimerDevice< 1, false, 12, 13, 14, 11 >( channel, irq_router, crystal );
 						ports->segment( new DeviceRegister( (Notification *)timer1, Timer::OCRnBH ), EXT_IO( 0x8B ));
 						ports->segment( new DeviceRegister( (Notification *)timer1, Timer::OCRnBL ), EXT_IO( 0x8A ));
 						ports->segment( new DeviceRegister( (Notification *)timer1, Timer::OCRnAH ), EXT_IO( 0x89 ));
@@ -299,7 +295,6 @@ static CPU *atmega328p( Reporter *channel, Coverage *tracker, const char *load,
 						ports->segment( new DeviceRegister( (Notification *)timer1, Timer::TCCRnA ), EXT_IO( 0x80 ));
 						ports->segment( new DeviceRegister( (Notification *)timer1, Timer::TIMSKn ), EXT_IO( 0x6F ));
 						ports->segment( new DeviceRegister( (Notification *)timer1, Timer::TIFRn ), 0x16 );
-						crystal->add( Timer::System_Clock, timer1 );
 	
 					//
 					//	Timer 2, the second 8 bit timer.
@@ -308,7 +303,7 @@ static CPU *atmega328p( Reporter *channel, Coverage *tracker, const char *load,
 					//	9	0x008 TIMER2_COMPB Timer/Counter2 Compare Match B
 					//	10	0x009 TIMER2_OVF Timer/Counter2 Overflow
 					//
-	Timer		*timer2		= new TimerDevice< 2, true, 8, 9, 10, 0 >( channel, irq_router );
+	Timer		*timer2		= new TimerDevice< 2, true, 8, 9, 10, 0 >( channel, irq_router, crystal );
 						ports->segment( new DeviceRegister( (Notification *)timer2, Timer::OCRnB ), EXT_IO( 0xB4 ));
 						ports->segment( new DeviceRegister( (Notification *)timer2, Timer::OCRnA ), EXT_IO( 0xB3 ));
 						ports->segment( new DeviceRegister( (Notification *)timer2, Timer::TCNTn ), EXT_IO( 0xB2 ));
@@ -316,7 +311,15 @@ static CPU *atmega328p( Reporter *channel, Coverage *tracker, const char *load,
 						ports->segment( new DeviceRegister( (Notification *)timer2, Timer::TCCRnA ), EXT_IO( 0xB0 ));
 						ports->segment( new DeviceRegister( (Notification *)timer2, Timer::TIMSKn ), EXT_IO( 0x70 ));
 						ports->segment( new DeviceRegister( (Notification *)timer2, Timer::TIFRn ), 0x17 );
-						crystal->add( Timer::System_Clock, timer2 );
+						//
+						//	Timer 2 keeps running (and so can wake
+						//	the CPU) in these sleep modes.
+						//
+						for( byte irq = 8; irq <= 10; irq++ ) {
+							processor->wake_on( AVR_CPU::Sleep_ADC_Noise, irq );
+							processor->wake_on( AVR_CPU::Sleep_Power_Save, irq );
+							processor->wake_on( AVR_CPU::Sleep_Extended_Standby, irq );
+						}
 					//
 					//	The Flash (Re)Programming Device.
 					//
@@ -326,7 +329,7 @@ static CPU *atmega328p( Reporter *channel, Coverage *tracker, const char *load,
 					//
 	Programmer	*programmer	= new ProgrammerDevice< 26 >( channel, 0, firmware, processor, irq_router, crystal, fuses );
 						ports->segment( new DeviceRegister( (Notification *)programmer, Programmer::SPMCSR ), 0x37 );
-						crystal->add( Programmer::System_Clock, programmer );
+						processor->wake_on( AVR_CPU::Sleep_ADC_Noise, 26 );
 
 					//
 					//	Finally create and include the program data space itself.
@@ -367,6 +370,22 @@ static CPU *atmega328p( Reporter *channel, Coverage *tracker, const char *load,
 #define LIST	32
 #define BUFFER	128
 
+
+//
+//	Describe the access which has triggered a watch point.
+//
+static void watch_hit( WatchPoint *watches, Symbols *labels ) {
+	char	buffer[ BUFFER ];
+	word	adrs;
+	byte	kinds,
+		value;
+	int	n;
+
+	n = watches->last( &adrs, &kinds, &value );
+	printf( "Watch point %d, %s $%02X at %s.\n", n, ( kinds & WatchPoint::Watch_Read )? "read": (( kinds & WatchPoint::Watch_Change )? "change to": "write" ), (int)value, labels->expand( memory_address, adrs, buffer, BUFFER ));
+}
+
+
 int main( int argc, char* argv[]) {
 	char	*hex;
 	
@@ -409,13 +428,16 @@ int main( int argc, char* argv[]) {
 	
 	Environment	*global		= new Environment( channel );
 	BreakPoint	*breaks		= new BreakPoint();
+	WatchPoint	*watches	= new WatchPoint();
 	Coverage	*tracker	= new Coverage( channel, 0 );
+	HeatMap		*heat		= new HeatMap( channel, 0, crystal );
 	CPU		*simulate	= atmega328p( channel, tracker, hex, fuses, crystal, global );
 
 	//
 	//	Prepare to catch Ctrl-C
 	//
 	signal( SIGINT, Ctrl_C );
+	simulate->stop_on( breaks, watches, &keep_running );
 	
 	while( true ) {
 		char	adrs[ BUFFER ],
@@ -426,6 +448,8 @@ int main( int argc, char* argv[]) {
 		dword	pc	= simulate->next_instruction();
 		word	len	= simulate->disassemble( pc, labels, inst, BUFFER );
 
+		simulate->publish();
+
 		printf( "%s %s: %s\n", crystal->count_text( time, BUFFER ), labels->expand( program_address, pc, adrs, BUFFER ), inst );
 		printf( "> " );
 		fflush( stdout );
@@ -446,11 +470,21 @@ int main( int argc, char* argv[]) {
 			}
 			case 'r': {
 				//
-				//	Run, or run a number of instructions.
+				//	Run, or run a number of instructions, a number
+				//	of clock cycles ('c' following the number), a
+				//	simulated duration ('s', 'ms' or 'us' following
+				//	the number) or until the clock reaches a cycle
+				//	('@' before the number).
 				//
-				bool	counter;
-				int	left, count, n;
+				bool		counter;
+				BudgetUnit	unit;
+				qword		count,
+						ran;
+				int		n;
+				char		*end;
 
+				unit = Instruction_Budget;
+				count = 0;
 				if( *dec == 's' ) {
 					//
 					//	set up a break after this instruction
@@ -458,30 +492,61 @@ int main( int argc, char* argv[]) {
 					counter = false;
 					breaks->add( simulate->next_instruction() + simulate->instruction_size());
 				}
+				else if( *dec == '@' ) {
+					//
+					//	Until a specific clock cycle.
+					//
+					count = strtoull( dec + 1, &end, 10 );
+					unit = Until_Cycle;
+					counter = true;
+				}
 				else {
 					//
-					//	One or fixed number of instructions
+					//	One or fixed number of instructions, or
+					//	a length of simulated time.
 					//
-					counter = (( left = ( count = atoi( dec ))) > 0 );
+					count = strtoull( dec, &end, 10 );
+					if( strcmp( end, "c" ) == 0 ) {
+						unit = Cycle_Budget;
+					}
+					else if( strcmp( end, "s" ) == 0 ) {
+						count = crystal->ticks( count, 1 );
+						unit = Cycle_Budget;
+					}
+					else if( strcmp( end, "ms" ) == 0 ) {
+						count = crystal->ticks( count, 1000 );
+						unit = Cycle_Budget;
+					}
+					else if( strcmp( end, "us" ) == 0 ) {
+						count = crystal->ticks( count, 1000000 );
+						unit = Cycle_Budget;
+					}
+					counter = ( count > 0 );
 				}
-				while( keep_running ) {
-					simulate->step();
-					if(( n = breaks->check( simulate->next_instruction())) != 0 ) {
+				//
+				//	The CPU runs until something stops it; SLEEP
+				//	is not treated as a reason to stop.
+				//
+				switch( simulate->run( counter? count: 0, unit, Stop_All & ~BIT( word, Stop_Sleep ), &ran, &n )) {
+					case Stop_Breakpoint: {
 						printf( "Break point %d.\n", n );
 						break;
 					}
-					if( counter ) {
-						if( --count == 0 ) break;
-						if( channel->exception()) {
-							printf( "Exception after %d instructions.\n",  left - count  );
-							break;
+					case Stop_Exception: {
+						if( counter ) {
+							printf( "Exception after %lld instructions.\n", (long long int)ran );
 						}
-					}
-					else {
-						if( channel->exception()) {
+						else {
 							printf( "Exception stops execution.\n" );
-							break;
 						}
+						break;
+					}
+					case Stop_Watchpoint: {
+						watch_hit( watches, labels );
+						break;
+					}
+					default: {
+						break;
 					}
 				}
 				break;
@@ -493,6 +558,7 @@ int main( int argc, char* argv[]) {
 				//
 				bool	counter;
 				int	left, count, n;
+				bool	going;
 
 				if( *dec == 's' ) {
 					//
@@ -507,25 +573,39 @@ int main( int argc, char* argv[]) {
 					//
 					counter = (( left = ( count = atoi( dec ))) > 0 );
 				}
-				while( keep_running ) {
-					simulate->step();
-					if(( n = breaks->check( simulate->next_instruction())) != 0 ) {
-						printf( "Break point %d.\n", n );
-						break;
-					}
-					if( counter ) {
-						if( --count == 0 ) break;
-						if( channel->exception()) {
-							printf( "Exception after %d instructions.\n", count - left );
+				going = true;
+				while( going ) {
+					switch( simulate->run( 1, Instruction_Budget, Stop_All & ~BIT( word, Stop_Sleep ), NULL, &n )) {
+						case Stop_Breakpoint: {
+							printf( "Break point %d.\n", n );
+							going = false;
 							break;
 						}
-					}
-					else {
-						if( channel->exception()) {
-							printf( "Exception stops execution.\n" );
+						case Stop_Exception: {
+							if( counter ) {
+								printf( "Exception after %d instructions.\n", left - count + 1 );
+							}
+							else {
+								printf( "Exception stops execution.\n" );
+							}
+							going = false;
+							break;
+						}
+						case Stop_Watchpoint: {
+							watch_hit( watches, labels );
+							going = false;
+							break;
+						}
+						case Stop_Interrupted: {
+							going = false;
+							break;
+						}
+						default: {
+							if( counter && ( --count == 0 )) going = false;
 							break;
 						}
 					}
+					if( !going ) break;
 					pc = simulate->next_instruction();
 					len = simulate->disassemble( pc, labels, inst, BUFFER );
 					printf( "%s %s: %s\n", crystal->count_text( time, BUFFER ), labels->expand( program_address, pc, adrs, BUFFER ), inst );
@@ -721,10 +801,64 @@ int main( int argc, char* argv[]) {
 				}
 				break;
 			}
+			case 'a': {
+				//
+				//	Add a watch point: aK@A or aK@A,A where K
+				//	is any of 'r', 'w' and 'c'.
+				//
+				word	n;
+				dword	a1, a2;
+				byte	k;
+				char	*at, *c;
+
+				if(( at = strchr( dec, '@' )) == NULL ) {
+					printf( "Watch point address not supplied.\n" );
+					break;
+				}
+				*at++ = EOS;
+				k = 0;
+				while( *dec != EOS ) {
+					switch( *dec++ ) {
+						case 'r': k |= WatchPoint::Watch_Read; break;
+						case 'w': k |= WatchPoint::Watch_Write; break;
+						case 'c': k |= WatchPoint::Watch_Change; break;
+						default: k = 0; *dec = EOS; break;
+					}
+				}
+				if( k == 0 ) {
+					printf( "Watch point kind is any of 'r', 'w' or 'c'.\n" );
+					break;
+				}
+				if(( c = strchr( at, COMMA )) != NULL ) *c++ = EOS;
+				if( !labels->evaluate( memory_address, at, &a1 ) || (( c != NULL ) && !labels->evaluate( memory_address, c, &a2 ))) {
+					printf( "Invalid watch point address\n" );
+					break;
+				}
+				if( c == NULL ) a2 = a1;
+				if( a2 < a1 ) {
+					printf( "Invalid end of watch point range.\n" );
+					break;
+				}
+				if(( n = watches->add( a1, a2+1, k )) == 0 ) {
+					printf( "Unable to add new watch point.\n" );
+				}
+				else {
+					printf( "Watch point %d set.\n", n );
+				}
+				break;
+			}
 			case 'x': {
 				//
-				//	Remove a break point
+				//	Remove a break point, or a watch point
 				//
+				if( *dec == 'w' ) {
+					word n = atoi( dec+1 );
+
+					if( !watches->remove( n )) {
+						printf( "Invalid watch point %d.\n", n );
+					}
+					break;
+				}
 				word n = atoi( dec );
 
 				if( !breaks->remove( n )) {
@@ -758,6 +892,105 @@ int main( int argc, char* argv[]) {
 						}
 						break;
 					}
+					case 'b': {
+						//
+						//	Benchmark the instruction decoder.
+						//
+						simulate->benchmark( atoi( dec ), stdout );
+						break;
+					}
+					case 'l': {
+						//
+						//	Busy loop skipping on or off.
+						//
+						simulate->skip_loops( atoi( dec ) != 0 );
+						break;
+					}
+					case 'j': {
+						//
+						//	Native code on or off.
+						//
+						simulate->jit( labels, atoi( dec ) != 0 );
+						break;
+					}
+					case 'k': {
+						char	*p;
+						dword	l, b;
+
+						//
+						//	Set the stack limit, and the heap top
+						//	variable if given.
+						//
+						b = 0;
+						if(( p = strchr( dec, COMMA )) != NULL ) *p++ = EOS;
+						if( !labels->evaluate( memory_address, dec, &l ) || (( p != NULL ) && !labels->evaluate( memory_address, p, &b ))) {
+							printf( "Set stack limit: !kA or !kA,H\n" );
+							break;
+						}
+						simulate->stack_limit( labels, (word)l, (word)b );
+						break;
+					}
+					case 'e': {
+						char	*p;
+						dword	n;
+
+						//
+						//	Export the MCU state through shared
+						//	memory, every N cycles if given.
+						//
+						n = 10000;
+						if(( p = strchr( dec, COMMA )) != NULL ) {
+							*p++ = EOS;
+							if(( n = atol( p )) == 0 ) {
+								printf( "Export state: !eNAME or !eNAME,N\n" );
+								break;
+							}
+						}
+						if( *dec != '/' ) {
+							printf( "Shared memory names start with '/'.\n" );
+							break;
+						}
+						if( simulate->share_state( dec, n )) printf( "Exporting state through '%s'.\n", dec );
+						break;
+					}
+					case 'a': {
+						dword	n;
+
+						//
+						//	Start (or stop) a data access heat map
+						//	with windows of N cycles.
+						//
+						if(( n = atol( dec )) == 0 ) {
+							simulate->heat_map( NULL );
+							printf( "Heat map stopped.\n" );
+							break;
+						}
+						heat->start( labels, n );
+						simulate->heat_map( heat );
+						break;
+					}
+					case 'm': {
+						//
+						//	Write the heat map matrix to a file.
+						//
+						if( heat->matrix( dec )) printf( "done.\n" );
+						break;
+					}
+					case 'p': {
+						//
+						//	Pace the simulation at a multiple of real
+						//	time, or unpaced (0).
+						//
+						crystal->pace( atof( dec ), &keep_running );
+						break;
+					}
+					case 'u': {
+						//
+						//	Uninitialised SRAM reporting on or off.
+						//
+						simulate->uninitialised( labels, atoi( dec ) != 0 );
+						break;
+					}
 					case 'r': {
 						//
 						//	Reset MCU.
@@ -851,10 +1084,11 @@ int main( int argc, char* argv[]) {
 					}
 					case 'b': {
 						//
-						//	Breakpoints
+						//	Breakpoints and watch points
 						//
 						int	id[ LIST ],
-							count;
+							count,
+							watching;
 							
 						if(( count = breaks->list( id, LIST ))) {
 							printf( "Break points:\n" );
@@ -872,11 +1106,71 @@ int main( int argc, char* argv[]) {
 								}
 							}
 						}
-						else {
+						if(( watching = watches->list( id, LIST ))) {
+							printf( "Watch points:\n" );
+							for( int i = 0; i < watching; i++ ) {
+								dword	s, e, h;
+								byte	k;
+								char	kind[ 4 ];
+
+								if( watches->address( id[ i ], &s, &e, &k, &h )) {
+									e -= 1;
+									if( e == s ) {
+										printf( "\t%d %s @ %s (%ld hits)\n", id[ i ], WatchPoint::kind_text( k, kind ), labels->expand( memory_address, s, inst, BUFFER ), (long)h );
+									}
+									else {
+										printf( "\t%d %s @ %s,%s (%ld hits)\n", id[ i ], WatchPoint::kind_text( k, kind ), labels->expand( memory_address, s, inst, BUFFER ), labels->expand( memory_address, e, adrs, BUFFER ), (long)h );
+									}
+								}
+							}
+						}
+						if(( count == 0 )&&( watching == 0 )) {
 							printf( "No breaks set.\n" );
 						}
 						break;
 					}
+					case 'h': {
+						//
+						//	Hottest basic blocks.
+						//
+						simulate->profile( atoi( dec ), labels, stdout );
+						break;
+					}
+					case 'f': {
+						//
+						//	Fused instruction sequences.
+						//
+						simulate->fusions( stdout );
+						break;
+					}
+					case 'l': {
+						//
+						//	Busy loops found and skipped.
+						//
+						simulate->busy_loops( stdout );
+						break;
+					}
+					case 'j': {
+						//
+						//	Native code translated and run.
+						//
+						simulate->natives( stdout );
+						break;
+					}
+					case 'a': {
+						//
+						//	Hottest variables by heat map window.
+						//
+						heat->summary( atoi( dec ), stdout );
+						break;
+					}
+					case 'k': {
+						//
+						//	Stack usage.
+						//
+						simulate->stack_usage( labels, stdout );
+						break;
+					}
 					case 'c': {
 						//
 						//	Coverage data.
@@ -939,6 +1233,10 @@ int main( int argc, char* argv[]) {
 						printf( "wF\tSave symbols to file F\n" );
 						printf( "bA\tSet breakpoint at address A\n" );
 						printf( "xN\tDelete breakpoint number N\n" );
+						printf( "aK@A\tSet watch point on data address A, K is any of\n" );
+						printf( "\t'r' read, 'w' write or 'c' change\n" );
+						printf( "aK@A,A\tas above but on a range of addresses\n" );
+						printf( "xwN\tDelete watch point number N\n" );
 						printf( "?\tThis help\n" );
 						printf( "?v\tDisplay symbols by value\n" );
 						printf( "?s\tDisplay symbols by name\n" );
@@ -946,11 +1244,27 @@ int main( int argc, char* argv[]) {
 						printf( "?rN\tDisplay CPU register N\n" );
 						printf( "?p\tDisplay all ports\n" );
 						printf( "?pN\tDisplay port number N\n" );
-						printf( "?b\tDisplay breakpoints\n" );
+						printf( "?b\tDisplay breakpoints and watch points\n" );
 						printf( "?ca\tDisplay all coverage data\n" );
 						printf( "?cp\tDisplay program coverage data\n" );
 						printf( "?cm\tDisplay memory coverage data\n" );
+						printf( "?hN\tDisplay the N hottest code blocks\n" );
+						printf( "?f\tDisplay fused instruction sequence counts\n" );
+						printf( "?l\tDisplay busy loop counts and cycles skipped\n" );
+						printf( "?j\tDisplay native code blocks and runs\n" );
+						printf( "?k\tDisplay stack usage, overall and by interrupt\n" );
+						printf( "?aN\tDisplay the N most accessed variables in each heat map window\n" );
 						printf( "!r\tCPU reset\n" );
+						printf( "!bN\tBenchmark instruction decoding (N passes)\n" );
+						printf( "!lN\tSkip busy loops on (N=1) or off (N=0)\n" );
+						printf( "!jN\tNative code for hot blocks on (N=1) or off (N=0)\n" );
+						printf( "!uN\tReport uninitialised SRAM reads on (N=1) or off (N=0)\n" );
+						printf( "!kA\tReport the stack reaching below address A\n" );
+						printf( "!kA,H\tas above, or below the heap top held at H\n" );
+						printf( "!eNAME\tExport MCU state to shared memory NAME (see SharedState.h)\n" );
+						printf( "!eNAME,N\tas above, updated every N cycles while running\n" );
+						printf( "!aN\tStart a data access heat map, windows of N cycles (0 stops)\n" );
+						printf( "!mF\tWrite the heat map matrix to file F\n" );
 						printf( "!dT\tDisplay serial terminal T\n" );
 						printf( "!sT,N\tSupply value N to serial terminal T\n" );
 						printf( "\n\tN and A have the form '({symbol}[+-])?{number}'\n" );